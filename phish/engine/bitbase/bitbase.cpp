@@ -0,0 +1,404 @@
+#include "engine/bitbase/bitbase.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+
+#include "engine/board/position.h"
+#include "engine/util/memory.h"
+
+namespace phish::bitbase {
+
+namespace {
+
+constexpr char MAGIC[4] = {'P', 'H', 'B', 'B'};
+constexpr uint32_t VERSION = 1;
+constexpr std::size_t HEADER_BYTES = 64;
+constexpr const char* EXTENSION = ".pbb";
+
+constexpr char PIECE_LETTERS[] = "PNBRQK";
+
+// White's king squares without pawns: the a1-d1-d4 triangle.
+constexpr Square TRIANGLE[10] = {SQ_A1, SQ_B1, SQ_C1, SQ_D1, SQ_B2, SQ_C2, SQ_D2, SQ_C3, SQ_D3, SQ_D4};
+
+constexpr int triangle_index(Square s) {
+    for (int i = 0; i < 10; ++i)
+        if (TRIANGLE[i] == s) return i;
+    return -1;
+}
+
+constexpr Square flip_file(Square s) { return static_cast<Square>(s ^ 7); }
+constexpr Square flip_rank(Square s) { return static_cast<Square>(s ^ 56); }
+constexpr Square transpose(Square s) { return static_cast<Square>(((s >> 3) | (s << 3)) & 63); }
+
+
+// Sorts one side's pieces strongest first.
+void sort_side(Material& m, Color c) {
+    std::sort(m.pieces[c], m.pieces[c] + m.count[c], [](PieceType a, PieceType b) { return a > b; });
+}
+
+bool stronger(const Material& m, Color a, Color b) {
+    if (m.count[a] != m.count[b]) return m.count[a] > m.count[b];
+    for (int i = 0; i < m.count[a]; ++i)
+        if (m.pieces[a][i] != m.pieces[b][i]) return m.pieces[a][i] > m.pieces[b][i];
+    return false;
+}
+
+// Men of each kind, four bits per Piece; the key the registry is looked up by.
+uint64_t signature(const Material& m, bool flipped) {
+    uint64_t sig = 0;
+    for (Color c : {WHITE, BLACK})
+        for (int i = 0; i < m.count[c]; ++i) {
+            const Piece pc = make_piece(flipped ? opposite(c) : c, m.pieces[c][i]);
+            sig += 1ULL << (4 * pc);
+        }
+    return sig;
+}
+
+class Table {
+public:
+    Table() = default;
+    Table(const Table&) = delete;
+    Table& operator=(const Table&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+
+    Wdl get(Color stm, uint64_t index) const {
+        const int v = (data[stm][index >> 2] >> ((index & 3) * 2)) & 3;
+        return v == 1 ? Wdl::Win : v == 2 ? Wdl::Loss : Wdl::Draw;
+    }
+
+    Material material;
+    Indexer indexer{Material{}};
+
+private:
+    bool bind(std::string& error);
+
+    memory::MappedFile file;
+    const unsigned char* base = nullptr;
+    std::size_t bytes = 0;
+    const unsigned char* data[COLOR_NB] = {};
+};
+
+bool Table::bind(std::string& error) {
+    if (bytes < HEADER_BYTES || std::memcmp(base, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "not a phish bitbase";
+        return false;
+    }
+    uint32_t version;
+    std::memcpy(&version, base + 4, sizeof(version));
+    if (version != VERSION) {
+        error = "unsupported version " + std::to_string(version);
+        return false;
+    }
+    Material m;
+    m.count[WHITE] = base[8];
+    m.count[BLACK] = base[9];
+    if (m.count[WHITE] + m.count[BLACK] > MAX_MEN - 2) {
+        error = "too many men";
+        return false;
+    }
+    for (Color c : {WHITE, BLACK})
+        for (int i = 0; i < m.count[c]; ++i) {
+            const int pt = base[10 + 2 * c + i];
+            if (pt >= KING) {
+                error = "bad material";
+                return false;
+            }
+            m.pieces[c][i] = static_cast<PieceType>(pt);
+        }
+    Material canonical;
+    if (!parse_material(m.name(), canonical) || canonical.name() != m.name()) {
+        error = "bad material";
+        return false;
+    }
+    uint64_t fields[3]; // entries, offsets of the two halves
+    std::memcpy(fields, base + 16, sizeof(fields));
+    material = m;
+    indexer = Indexer(m);
+    const uint64_t half = (indexer.size() + 3) / 4;
+    if (fields[0] != indexer.size() || fields[1] + half > bytes || fields[2] + half > bytes) {
+        error = "wrong size";
+        return false;
+    }
+    data[WHITE] = base + fields[1];
+    data[BLACK] = base + fields[2];
+    return true;
+}
+
+bool Table::open(const std::string& path, std::string& error) {
+    if constexpr (std::endian::native != std::endian::little) {
+        error = "big-endian hosts are not supported";
+        return false;
+    }
+    if (!file.open(path, error)) return false;
+    base = file.data();
+    bytes = file.size();
+    if (!bind(error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+// A table and whether the position's colours must be swapped to look it up.
+struct Entry {
+    const Table* table = nullptr;
+    bool flipped = false;
+};
+
+struct Registry {
+    std::vector<std::unique_ptr<Table>> tables;
+    std::unordered_map<uint64_t, Entry> entries;
+    int maxMen = 0;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+} // namespace
+
+bool Material::has_pawns(Color c) const {
+    return std::find(pieces[c], pieces[c] + count[c], PAWN) != pieces[c] + count[c];
+}
+
+std::string Material::name() const {
+    std::string s;
+    for (Color c : {WHITE, BLACK}) {
+        if (c == BLACK) s += 'v';
+        s += 'K';
+        for (int i = 0; i < count[c]; ++i) s += PIECE_LETTERS[pieces[c][i]];
+    }
+    return s;
+}
+
+bool parse_material(const std::string& name, Material& m) {
+    m = Material{};
+    int side = -1;
+    for (char ch : name) {
+        if (ch == 'v') continue;
+        if (ch == 'K') {
+            if (++side > BLACK) return false;
+            continue;
+        }
+        const char* p = std::strchr(PIECE_LETTERS, ch);
+        if (side < 0 || ch == '\0' || !p || *p == 'K') return false;
+        if (m.men() >= MAX_MEN) return false;
+        m.pieces[side][m.count[side]++] = static_cast<PieceType>(p - PIECE_LETTERS);
+    }
+    if (side != BLACK || m.men() < 3) return false;
+    sort_side(m, WHITE);
+    sort_side(m, BLACK);
+    if (stronger(m, BLACK, WHITE)) {
+        std::swap(m.pieces[WHITE], m.pieces[BLACK]);
+        std::swap(m.count[WHITE], m.count[BLACK]);
+    }
+    return !(m.has_pawns(WHITE) && m.has_pawns(BLACK));
+}
+
+std::vector<Material> all_materials() {
+    std::vector<Material> out;
+    const std::string letters = "QRBNP";
+    std::vector<std::string> names;
+    for (char a : letters) names.push_back(std::string("K") + a + "vK");
+    for (std::size_t a = 0; a < letters.size(); ++a)
+        for (std::size_t b = a; b < letters.size(); ++b) {
+            names.push_back(std::string("K") + letters[a] + letters[b] + "vK");
+            names.push_back(std::string("K") + letters[a] + "vK" + letters[b]);
+        }
+    for (const std::string& n : names) {
+        Material m;
+        if (parse_material(n, m)) out.push_back(m);
+    }
+    std::stable_sort(out.begin(), out.end(), [](const Material& x, const Material& y) { return x.men() < y.men(); });
+    return out;
+}
+
+Indexer::Indexer(const Material& m) {
+    pieceOf[slots++] = W_KING;
+    pieceOf[slots++] = B_KING;
+    for (Color c : {WHITE, BLACK})
+        for (int i = 0; i < m.count[c]; ++i) pieceOf[slots++] = make_piece(c, m.pieces[c][i]);
+    pawns = m.has_pawns(WHITE) || m.has_pawns(BLACK);
+    entries = pawns ? 32 : 10;
+    for (int s = 1; s < slots; ++s) entries *= (piece_type(pieceOf[s]) == PAWN) ? 48 : 64;
+}
+
+uint64_t Indexer::index(const Square* squares) const {
+    Square sq[MAX_MEN];
+    std::copy(squares, squares + slots, sq);
+    if (file_of(sq[0]) > 3)
+        for (int s = 0; s < slots; ++s) sq[s] = flip_file(sq[s]);
+    uint64_t idx;
+    if (pawns) {
+        idx = rank_of(sq[0]) * 4 + file_of(sq[0]);
+    } else {
+        if (rank_of(sq[0]) > 3)
+            for (int s = 0; s < slots; ++s) sq[s] = flip_rank(sq[s]);
+        // On the a1-h8 diagonal the king is fixed by the transposition too;
+        // the first man off it then goes below.
+        bool transposed = rank_of(sq[0]) > file_of(sq[0]);
+        for (int s = 1; s < slots && rank_of(sq[0]) == file_of(sq[0]); ++s)
+            if (rank_of(sq[s]) != file_of(sq[s])) {
+                transposed = rank_of(sq[s]) > file_of(sq[s]);
+                break;
+            }
+        if (transposed)
+            for (int s = 0; s < slots; ++s) sq[s] = transpose(sq[s]);
+        idx = static_cast<uint64_t>(triangle_index(sq[0]));
+    }
+    for (int s = 1; s < slots; ++s) {
+        if (piece_type(pieceOf[s]) == PAWN) idx = idx * 48 + (sq[s] - 8);
+        else idx = idx * 64 + sq[s];
+    }
+    return idx;
+}
+
+bool Indexer::decode(uint64_t index, Square* squares) const {
+    U64 occupied = 0;
+    for (int s = slots - 1; s >= 1; --s) {
+        const bool pawn = piece_type(pieceOf[s]) == PAWN;
+        const uint64_t range = pawn ? 48 : 64;
+        squares[s] = static_cast<Square>(index % range + (pawn ? 8 : 0));
+        index /= range;
+    }
+    squares[0] = pawns ? make_square(static_cast<int>(index % 4), static_cast<int>(index / 4)) : TRIANGLE[index];
+    for (int s = 0; s < slots; ++s) {
+        if (occupied & Bit(squares[s])) return false;
+        occupied |= Bit(squares[s]);
+    }
+    return true;
+}
+
+int load(const std::string& dir, std::string& message) {
+    clear();
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        if (entry.path().extension() == EXTENSION) paths.push_back(entry.path().string());
+    if (ec) {
+        message = "bitbases not loaded: cannot read " + dir;
+        return 0;
+    }
+    std::sort(paths.begin(), paths.end());
+    std::string errors;
+    for (const std::string& path : paths) {
+        std::string error;
+        if (!load_file(path, error)) errors += "; " + error;
+    }
+    const Registry& r = registry();
+    message = "bitbases: " + std::to_string(r.tables.size()) + " tables, up to " + std::to_string(r.maxMen) +
+              " men, from " + dir + errors;
+    return static_cast<int>(r.tables.size());
+}
+
+bool load_file(const std::string& path, std::string& error) {
+    auto table = std::make_unique<Table>();
+    if (!table->open(path, error)) return false;
+    Registry& r = registry();
+    if (loaded(table->material)) {
+        error = path + ": " + table->material.name() + " is already loaded";
+        return false;
+    }
+    r.entries[signature(table->material, false)] = {table.get(), false};
+    r.entries.emplace(signature(table->material, true), Entry{table.get(), true});
+    r.maxMen = std::max(r.maxMen, table->material.men());
+    r.tables.push_back(std::move(table));
+    return true;
+}
+
+void clear() {
+    Registry& r = registry();
+    r.entries.clear();
+    r.tables.clear();
+    r.maxMen = 0;
+}
+
+int max_men() { return registry().maxMen; }
+
+bool loaded(const Material& m) { return registry().entries.count(signature(m, false)) != 0; }
+
+bool probe(const board::Position& pos, Wdl& wdl) {
+    const U64 occupied = pos.color_bb(WHITE) | pos.color_bb(BLACK);
+    if (std::popcount(occupied) > registry().maxMen || pos.castling_rights()) return false;
+    Piece pieces[MAX_MEN];
+    Square squares[MAX_MEN];
+    int count = 0;
+    for (U64 b = occupied; b; b &= b - 1) {
+        const Square s = static_cast<Square>(__builtin_ctzll(b));
+        pieces[count] = static_cast<Piece>(pos.piece_at(s));
+        squares[count++] = s;
+    }
+    return probe(pieces, squares, count, pos.side_to_move(), wdl);
+}
+
+bool probe(const Piece* pieces, const Square* squares, int count, Color stm, Wdl& wdl) {
+    if (count == 2) {
+        wdl = Wdl::Draw;
+        return true;
+    }
+    const Registry& r = registry();
+    if (count > r.maxMen) return false;
+    uint64_t sig = 0;
+    for (int i = 0; i < count; ++i)
+        if (piece_type(pieces[i]) != KING) sig += 1ULL << (4 * pieces[i]);
+    const auto it = r.entries.find(sig);
+    if (it == r.entries.end()) return false;
+    const Entry& e = it->second;
+    const Indexer& ix = e.table->indexer;
+    if (ix.men() != count) return false;
+
+    Square slots[MAX_MEN];
+    bool used[MAX_MEN] = {};
+    for (int s = 0; s < count; ++s) {
+        const Piece pc = ix.piece(s);
+        const Piece want = e.flipped ? make_piece(opposite(piece_color(pc)), piece_type(pc)) : pc;
+        int i = 0;
+        while (used[i] || pieces[i] != want) ++i;
+        used[i] = true;
+        slots[s] = e.flipped ? flip_rank(squares[i]) : squares[i];
+    }
+    wdl = e.table->get(e.flipped ? opposite(stm) : stm, ix.index(slots));
+    return true;
+}
+
+bool save(const std::string& path, const Material& m, const std::vector<uint8_t> packed[COLOR_NB],
+          std::string& error) {
+    const Indexer ix(m);
+    const uint64_t half = (ix.size() + 3) / 4;
+    if (packed[WHITE].size() != half || packed[BLACK].size() != half) {
+        error = "wrong table size";
+        return false;
+    }
+    const uint64_t padded = (half + 63) / 64 * 64;
+    unsigned char header[HEADER_BYTES] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    std::memcpy(header + 4, &VERSION, sizeof(VERSION));
+    header[8] = static_cast<unsigned char>(m.count[WHITE]);
+    header[9] = static_cast<unsigned char>(m.count[BLACK]);
+    for (Color c : {WHITE, BLACK})
+        for (int i = 0; i < m.count[c]; ++i) header[10 + 2 * c + i] = static_cast<unsigned char>(m.pieces[c][i]);
+    const uint64_t fields[3] = {ix.size(), HEADER_BYTES, HEADER_BYTES + padded};
+    std::memcpy(header + 16, fields, sizeof(fields));
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(header), HEADER_BYTES);
+    const std::vector<char> zeros(padded - half, 0);
+    for (Color c : {WHITE, BLACK}) {
+        out.write(reinterpret_cast<const char*>(packed[c].data()), static_cast<std::streamsize>(half));
+        out.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    }
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace phish::bitbase
\ No newline at end of file
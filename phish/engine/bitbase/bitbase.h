@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/util/types.h"
+
+namespace phish::board {
+class Position;
+}
+
+namespace phish::bitbase {
+
+// Win/draw/loss for the side to move with perfect play, ignoring the
+// fifty-move rule.
+enum class Wdl { Loss = -1, Draw = 0, Win = 1 };
+
+constexpr int MAX_MEN = 4;
+
+// Pieces besides the two kings, each side's strongest first. A table holds
+// one material with White as the stronger side (more pieces, then the
+// better piece first): "KQvKR", never "KRvKQ".
+struct Material {
+    PieceType pieces[COLOR_NB][MAX_MEN - 2] = {};
+    int count[COLOR_NB] = {};
+
+    int men() const { return 2 + count[WHITE] + count[BLACK]; }
+    bool has_pawns(Color c) const;
+    std::string name() const;
+};
+
+// Parses "KQvKR" or "KQKR" into canonical order. False for anything a table
+// cannot hold: more than MAX_MEN men, a bare "KvK", or pawns on both sides
+// (the index has no en-passant square).
+bool parse_material(const std::string& name, Material& m);
+// Every material a table can hold, smallest first.
+std::vector<Material> all_materials();
+
+// Squares of a table position, in slot order: White's king, Black's king,
+// then the other pieces in Material order, White's before Black's.
+//
+// The index is per side to move. Without pawns White's king is folded into
+// the a1-d1-d4 triangle by the board's eight symmetries; with pawns only
+// the mirror through the d/e files applies and the king keeps half the
+// board. Pawns take 48 values (ranks 2 to 7), everything else 64. Indices
+// that index() never returns (two men on a square, or a folded orientation
+// of another entry) hold draws.
+class Indexer {
+public:
+    explicit Indexer(const Material& m);
+
+    // Entries per side to move.
+    uint64_t size() const { return entries; }
+    int men() const { return slots; }
+    Piece piece(int slot) const { return pieceOf[slot]; }
+
+    uint64_t index(const Square* squares) const;
+    // Squares of `index` in the folded orientation; false when the index
+    // puts two men on one square or a pawn on a back rank.
+    bool decode(uint64_t index, Square* squares) const;
+
+private:
+    int slots = 0;
+    bool pawns = false;
+    Piece pieceOf[MAX_MEN] = {};
+    uint64_t entries = 0;
+};
+
+// Tables found by load(), kept mapped until the next load() or clear().
+// Loading is not thread-safe; probing is.
+int load(const std::string& dir, std::string& message);
+// Adds one file to the loaded tables.
+bool load_file(const std::string& path, std::string& error);
+void clear();
+// Men of the largest loaded table, 0 with none loaded.
+int max_men();
+bool loaded(const Material& m);
+
+// False when no loaded table covers the position or it has castling rights.
+// No table has pawns on both sides, so an en-passant square never matters.
+bool probe(const board::Position& pos, Wdl& wdl);
+// The same for `count` men, kings included, in any order. Bare kings are a
+// draw without a table.
+bool probe(const Piece* pieces, const Square* squares, int count, Color stm, Wdl& wdl);
+
+// Writes a table: `packed[stm]` holds Indexer::size() entries of two bits,
+// four per byte, lowest first: 0 draw, 1 win, 2 loss.
+bool save(const std::string& path, const Material& m, const std::vector<uint8_t> packed[COLOR_NB],
+          std::string& error);
+
+} // namespace phish::bitbase
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include "engine/bitbase/generate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "engine/bitboard/bitboard.h"
+#include "engine/util/parallel.h"
+
+namespace phish::bitbase {
+
+namespace {
+
+using namespace bitboard;
+
+// Per-position state while solving; results are from the side to move's
+// point of view.
+enum : uint8_t { UNKNOWN = 0, WIN = 1, LOSS = 2, DRAW = 3, INVALID = 4 };
+
+// A position's count byte: moves to positions of the table not yet known
+// to win for the opponent, and whether some move leaves the table to a draw.
+constexpr uint8_t MOVE_COUNT = 0x7F;
+constexpr uint8_t DRAW_EXIT = 0x80;
+
+constexpr PieceType PROMOTIONS[4] = {QUEEN, ROOK, BISHOP, KNIGHT};
+
+U64 attacks(Piece pc, Square s, U64 occ) {
+    switch (piece_type(pc)) {
+        case PAWN: return PAWN_ATTACKS[piece_color(pc)][s];
+        case KNIGHT: return KNIGHT_ATTACKS[s];
+        case BISHOP: return sliding_attacks_bishop(s, occ);
+        case ROOK: return sliding_attacks_rook(s, occ);
+        case QUEEN: return sliding_attacks_bishop(s, occ) | sliding_attacks_rook(s, occ);
+        default: return KING_ATTACKS[s];
+    }
+}
+
+void add_unique(uint32_t* list, int& count, uint32_t value) {
+    if (std::find(list, list + count, value) == list + count) list[count++] = value;
+}
+
+class Solver {
+public:
+    Solver(const Material& m, int threads);
+
+    bool run(GenerateStats& stats, std::string& error);
+    void pack(std::vector<uint8_t> out[COLOR_NB]) const;
+
+private:
+    // Slot 0 is White's king and slot 1 Black's, so a colour is its king's slot.
+    bool attacked(Square target, Color by, const Square* sq, int removed, U64 occ) const {
+        for (int i = 0; i < men; ++i)
+            if (i != removed && piece_color(pieces[i]) == by && (attacks(pieces[i], sq[i], occ) & Bit(target)))
+                return true;
+        return false;
+    }
+    Color stm_of(uint64_t c) const { return c < size ? WHITE : BLACK; }
+
+    // Decodes `c`; false unless it is a legal position in canonical form.
+    bool position(uint64_t c, Square* sq) const;
+    // Scores `c` from its moves, or leaves it UNKNOWN with its move count set.
+    uint8_t score(uint64_t c, bool& missing);
+    // Distinct positions with a move to `c` that stays in the table.
+    int predecessors(uint64_t c, uint32_t* out) const;
+
+    Indexer ix;
+    int threads;
+    int men;
+    Piece pieces[MAX_MEN];
+    uint64_t size;
+    std::vector<uint8_t> result;
+    std::vector<uint8_t> moves;
+};
+
+Solver::Solver(const Material& m, int threadCount)
+    : ix(m), threads(std::max(1, threadCount)), men(ix.men()), size(ix.size()) {
+    for (int s = 0; s < men; ++s) pieces[s] = ix.piece(s);
+    result.assign(2 * size, UNKNOWN);
+    moves.assign(2 * size, 0);
+}
+
+bool Solver::position(uint64_t c, Square* sq) const {
+    const uint64_t idx = c % size;
+    if (!ix.decode(idx, sq) || (KING_ATTACKS[sq[WHITE]] & Bit(sq[BLACK]))) return false;
+    // Positions on a symmetry of the board that the index folds elsewhere.
+    if (ix.index(sq) != idx) return false;
+    U64 occ = 0;
+    for (int i = 0; i < men; ++i) occ |= Bit(sq[i]);
+    const Color stm = stm_of(c);
+    return !attacked(sq[opposite(stm)], stm, sq, -1, occ);
+}
+
+uint8_t Solver::score(uint64_t c, bool& missing) {
+    Square sq[MAX_MEN];
+    if (!position(c, sq)) return INVALID;
+    const Color us = stm_of(c), them = opposite(us);
+    U64 occ = 0, own = 0;
+    for (int i = 0; i < men; ++i) {
+        occ |= Bit(sq[i]);
+        if (piece_color(pieces[i]) == us) own |= Bit(sq[i]);
+    }
+
+    uint32_t children[128];
+    int childCount = 0;
+    bool legal = false, drawExit = false;
+    for (int i = 0; i < men; ++i) {
+        if (piece_color(pieces[i]) != us) continue;
+        const Square from = sq[i];
+        const bool pawn = piece_type(pieces[i]) == PAWN;
+        U64 targets;
+        if (pawn) {
+            const int up = us == WHITE ? 8 : -8;
+            const Square one = static_cast<Square>(from + up);
+            targets = PAWN_ATTACKS[us][from] & occ & ~own;
+            if (!(occ & Bit(one))) {
+                targets |= Bit(one);
+                const Square two = static_cast<Square>(one + up);
+                if (rank_of(from) == (us == WHITE ? 1 : 6) && !(occ & Bit(two))) targets |= Bit(two);
+            }
+        } else {
+            targets = attacks(pieces[i], from, occ) & ~own;
+        }
+
+        for (U64 b = targets; b; b &= b - 1) {
+            const Square to = static_cast<Square>(__builtin_ctzll(b));
+            int captured = -1;
+            for (int j = 0; j < men; ++j)
+                if (j != i && sq[j] == to) captured = j;
+            Square next[MAX_MEN];
+            std::copy(sq, sq + men, next);
+            next[i] = to;
+            if (attacked(next[us], them, next, captured, (occ ^ Bit(from)) | Bit(to))) continue;
+            legal = true;
+
+            const bool promotion = pawn && (rank_of(to) == 7 || rank_of(to) == 0);
+            if (captured < 0 && !promotion) {
+                add_unique(children, childCount, static_cast<uint32_t>(them * size + ix.index(next)));
+                continue;
+            }
+            // The move leaves the table: look the result up one material down.
+            for (int p = 0; p < (promotion ? 4 : 1); ++p) {
+                Piece exitPieces[MAX_MEN];
+                Square exitSquares[MAX_MEN];
+                int n = 0;
+                for (int j = 0; j < men; ++j) {
+                    if (j == captured) continue;
+                    exitPieces[n] = j == i && promotion ? static_cast<Piece>(us * 6 + PROMOTIONS[p]) : pieces[j];
+                    exitSquares[n++] = next[j];
+                }
+                Wdl wdl;
+                if (!probe(exitPieces, exitSquares, n, them, wdl)) {
+                    missing = true;
+                    return UNKNOWN;
+                }
+                if (wdl == Wdl::Loss) return WIN;
+                if (wdl == Wdl::Draw) drawExit = true;
+            }
+        }
+    }
+    if (!legal) return attacked(sq[us], them, sq, -1, occ) ? LOSS : DRAW;
+    if (childCount == 0) return drawExit ? DRAW : LOSS;
+    moves[c] = static_cast<uint8_t>(childCount | (drawExit ? DRAW_EXIT : 0));
+    return UNKNOWN;
+}
+
+int Solver::predecessors(uint64_t c, uint32_t* out) const {
+    Square sq[MAX_MEN];
+    ix.decode(c % size, sq);
+    const Color them = opposite(stm_of(c)); // the side that just moved
+    U64 occ = 0;
+    for (int i = 0; i < men; ++i) occ |= Bit(sq[i]);
+
+    int count = 0;
+    for (int i = 0; i < men; ++i) {
+        if (piece_color(pieces[i]) != them) continue;
+        const Square to = sq[i];
+        U64 origins;
+        if (piece_type(pieces[i]) == PAWN) {
+            const int down = them == WHITE ? -8 : 8;
+            const Square one = static_cast<Square>(to + down);
+            origins = 0;
+            if (rank_of(one) >= 1 && rank_of(one) <= 6 && !(occ & Bit(one))) {
+                origins |= Bit(one);
+                const Square two = static_cast<Square>(one + down);
+                if (rank_of(to) == (them == WHITE ? 3 : 4) && !(occ & Bit(two))) origins |= Bit(two);
+            }
+        } else {
+            origins = attacks(pieces[i], to, occ) & ~occ;
+        }
+
+        for (U64 b = origins; b; b &= b - 1) {
+            const Square from = static_cast<Square>(__builtin_ctzll(b));
+            Square prev[MAX_MEN];
+            std::copy(sq, sq + men, prev);
+            prev[i] = from;
+            // The side to move in `c` cannot have been left in check.
+            if (attacked(prev[opposite(them)], them, prev, -1, (occ ^ Bit(to)) | Bit(from))) continue;
+            add_unique(out, count, static_cast<uint32_t>(them * size + ix.index(prev)));
+        }
+    }
+    return count;
+}
+
+bool Solver::run(GenerateStats& stats, std::string& error) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<uint32_t>> found(threads);
+    std::atomic<bool> missing{false};
+    parallel(threads, 2 * size, [&](uint64_t begin, uint64_t end, int t) {
+        bool miss = false;
+        for (uint64_t c = begin; c < end && !miss; ++c) {
+            result[c] = score(c, miss);
+            if (result[c] == WIN || result[c] == LOSS) found[t].push_back(static_cast<uint32_t>(c));
+        }
+        if (miss) missing = true;
+    });
+    if (missing) {
+        error = "a table one capture or promotion away is not loaded";
+        return false;
+    }
+
+    stats.passes = 0;
+    std::vector<uint32_t> frontier;
+    while (true) {
+        frontier.clear();
+        for (std::vector<uint32_t>& f : found) {
+            frontier.insert(frontier.end(), f.begin(), f.end());
+            f.clear();
+        }
+        if (frontier.empty()) break;
+        ++stats.passes;
+        parallel(threads, frontier.size(), [&](uint64_t begin, uint64_t end, int t) {
+            uint32_t preds[256];
+            for (uint64_t k = begin; k < end; ++k) {
+                const uint32_t c = frontier[k];
+                const bool loss = result[c] == LOSS;
+                const int n = predecessors(c, preds);
+                for (int p = 0; p < n; ++p) {
+                    std::atomic_ref<uint8_t> r(result[preds[p]]);
+                    uint8_t expected = UNKNOWN;
+                    if (loss) {
+                        if (r.compare_exchange_strong(expected, WIN)) found[t].push_back(preds[p]);
+                        continue;
+                    }
+                    if (r.load(std::memory_order_relaxed) != UNKNOWN) continue;
+                    const uint8_t left = std::atomic_ref<uint8_t>(moves[preds[p]]).fetch_sub(1) - 1;
+                    if (left == 0 && r.compare_exchange_strong(expected, LOSS)) found[t].push_back(preds[p]);
+                }
+            }
+        });
+    }
+
+    stats.positions = stats.wins = stats.draws = stats.losses = 0;
+    for (uint8_t& r : result) {
+        if (r == UNKNOWN) r = DRAW;
+        if (r == INVALID) continue;
+        ++stats.positions;
+        if (r == WIN) ++stats.wins;
+        else if (r == LOSS) ++stats.losses;
+        else ++stats.draws;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void Solver::pack(std::vector<uint8_t> out[COLOR_NB]) const {
+    for (Color c : {WHITE, BLACK}) {
+        out[c].assign((size + 3) / 4, 0);
+        for (uint64_t i = 0; i < size; ++i) {
+            const uint8_t r = result[c * size + i];
+            const int code = r == WIN ? 1 : r == LOSS ? 2 : 0;
+            out[c][i >> 2] |= static_cast<uint8_t>(code << ((i & 3) * 2));
+        }
+    }
+}
+
+} // namespace
+
+std::vector<Material> successors(const Material& m) {
+    std::vector<Material> out;
+    const auto add = [&out](const Material& next) {
+        Material canonical;
+        if (next.men() < 3 || !parse_material(next.name(), canonical)) return;
+        for (const Material& o : out)
+            if (o.name() == canonical.name()) return;
+        out.push_back(canonical);
+    };
+    for (Color c : {WHITE, BLACK})
+        for (int i = 0; i < m.count[c]; ++i) {
+            Material next = m;
+            std::copy(next.pieces[c] + i + 1, next.pieces[c] + next.count[c], next.pieces[c] + i);
+            --next.count[c];
+            add(next);
+            if (m.pieces[c][i] != PAWN) continue;
+            for (PieceType pt : PROMOTIONS) {
+                next = m;
+                next.pieces[c][i] = pt;
+                add(next);
+            }
+        }
+    return out;
+}
+
+bool generate(const Material& m, const std::string& path, int threads, GenerateStats& stats, std::string& error) {
+    Solver solver(m, threads);
+    if (!solver.run(stats, error)) return false;
+    std::vector<uint8_t> packed[COLOR_NB];
+    solver.pack(packed);
+    return save(path, m, packed, error);
+}
+
+} // namespace phish::bitbase
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/bitbase/bitbase.h"
+
+namespace phish::bitbase {
+
+struct GenerateStats {
+    uint64_t positions = 0; // legal positions, both sides to move
+    uint64_t wins = 0;
+    uint64_t draws = 0;
+    uint64_t losses = 0;
+    int passes = 0; // propagation rounds, the longest win in plies plus one
+    double seconds = 0.0;
+};
+
+// Materials a capture or a promotion leads to, bare kings excluded. Their
+// tables must be loaded before generate() runs.
+std::vector<Material> successors(const Material& m);
+
+// Solves `m` by retrograde analysis on `threads` threads and saves it to
+// `path`. Every position is first scored from its moves alone: mates,
+// stalemates and the moves that leave the table, which are looked up in the
+// loaded smaller tables. Each round then marks the predecessors of the last
+// round's losses as wins and counts down the undecided moves of the
+// predecessors of its wins, which lose once none are left. What is still
+// undecided when a round adds nothing is a draw.
+bool generate(const Material& m, const std::string& path, int threads, GenerateStats& stats, std::string& error);
+
+} // namespace phish::bitbase
\ No newline at end of file
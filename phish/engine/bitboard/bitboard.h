@@ -13,6 +13,34 @@ extern U64 PAWN_ATTACKS[2][64];
 extern U64 FILE_MASKS[8];
 extern U64 RANK_MASKS[8];
 
+constexpr U64 FILE_A_BB = 0x0101010101010101ULL;
+constexpr U64 FILE_H_BB = FILE_A_BB << 7;
+
+// One-step shifts; squares pushed off the board are dropped.
+constexpr U64 shift_north(U64 b) { return b << 8; }
+constexpr U64 shift_south(U64 b) { return b >> 8; }
+constexpr U64 shift_east(U64 b) { return (b & ~FILE_H_BB) << 1; }
+constexpr U64 shift_west(U64 b) { return (b & ~FILE_A_BB) >> 1; }
+
+// Kogge-Stone fills: every square on or in the given direction of a set bit.
+constexpr U64 north_fill(U64 b) {
+    b |= b << 8;
+    b |= b << 16;
+    return b | (b << 32);
+}
+constexpr U64 south_fill(U64 b) {
+    b |= b >> 8;
+    b |= b >> 16;
+    return b | (b >> 32);
+}
+constexpr U64 file_fill(U64 b) { return north_fill(b) | south_fill(b); }
+
+// Squares attacked by all pawns of `c` in `pawns`.
+constexpr U64 pawn_attacks(Color c, U64 pawns) {
+    const U64 forward = c == WHITE ? shift_north(pawns) : shift_south(pawns);
+    return shift_east(forward) | shift_west(forward);
+}
+
 void init();
 
 U64 sliding_attacks_rook(Square from, U64 occ);
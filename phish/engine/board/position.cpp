@@ -10,13 +10,6 @@ namespace phish::board {
 
 namespace {
 
-Piece make_piece(Color c, PieceType pt) {
-    return static_cast<Piece>(static_cast<int>(c) * 6 + static_cast<int>(pt));
-}
-
-Color piece_color(Piece pc) { return static_cast<Color>(static_cast<int>(pc) / 6); }
-PieceType piece_type(Piece pc) { return static_cast<PieceType>(static_cast<int>(pc) % 6); }
-
 Piece char_to_piece(char ch) {
     Color c = std::isupper(static_cast<unsigned char>(ch)) ? WHITE : BLACK;
     char l = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
@@ -33,6 +26,24 @@ Piece char_to_piece(char ch) {
     return make_piece(c, pt);
 }
 
+// Material values used by static exchange evaluation.
+constexpr int SEE_VALUE[PIECE_TYPE_NB] = {100, 320, 330, 500, 900, 0};
+
+// Castling rights left after a move touching `from` and `to`.
+int castling_after(int rights, Square from, Square to) {
+    auto clear_castle = [&](Square s) {
+        if (s == SQ_E1) rights &= ~(1 | 2);
+        if (s == SQ_H1) rights &= ~1;
+        if (s == SQ_A1) rights &= ~2;
+        if (s == SQ_E8) rights &= ~(4 | 8);
+        if (s == SQ_H8) rights &= ~4;
+        if (s == SQ_A8) rights &= ~8;
+    };
+    clear_castle(from);
+    clear_castle(to);
+    return rights;
+}
+
 char piece_to_char(Piece pc) {
     const char tab[6] = {'p','n','b','r','q','k'};
     char ch = tab[piece_type(pc)];
@@ -100,7 +111,50 @@ bool Position::set_fen(const std::string& fen) {
     halfmove = half;
     fullmove = full;
 
-    // Build hash
+    compute_hash();
+    return true;
+}
+
+bool Position::set_packed(const PackedPosition& packed) {
+    const unsigned char* b = packed.bytes;
+    U64 occupied = 0;
+    for (int i = 0; i < 8; ++i) occupied |= static_cast<U64>(b[i]) << (8 * i);
+    if (__builtin_popcountll(occupied) > 32 || b[25] > SQ_NONE) return false;
+
+    *this = Position();
+    int n = 0;
+    for (U64 bb = occupied; bb; bb &= bb - 1, ++n) {
+        const int pc = (b[8 + n / 2] >> (4 * (n % 2))) & 15;
+        if (pc >= NO_PIECE) return false;
+        put_piece(static_cast<Piece>(pc), static_cast<Square>(__builtin_ctzll(bb)));
+    }
+    stm = (b[24] & 1) ? BLACK : WHITE;
+    castling = (b[24] >> 1) & 0xF;
+    ep = static_cast<Square>(b[25]);
+    halfmove = b[26];
+    fullmove = b[28] | b[29] << 8;
+    compute_hash();
+    return true;
+}
+
+bool Position::pack(PackedPosition& packed) const {
+    const U64 occupied = occupancy();
+    if (__builtin_popcountll(occupied) > 32) return false;
+    packed = PackedPosition();
+    unsigned char* b = packed.bytes;
+    for (int i = 0; i < 8; ++i) b[i] = static_cast<unsigned char>(occupied >> (8 * i));
+    int n = 0;
+    for (U64 bb = occupied; bb; bb &= bb - 1, ++n)
+        b[8 + n / 2] |= static_cast<unsigned char>(pieceOn[__builtin_ctzll(bb)] << (4 * (n % 2)));
+    b[24] = static_cast<unsigned char>((stm == BLACK ? 1 : 0) | castling << 1);
+    b[25] = static_cast<unsigned char>(ep);
+    b[26] = static_cast<unsigned char>(std::min(halfmove, 255));
+    b[28] = static_cast<unsigned char>(fullmove & 0xFF);
+    b[29] = static_cast<unsigned char>((fullmove >> 8) & 0xFF);
+    return true;
+}
+
+void Position::compute_hash() {
     hash = 0ULL;
     for (int s = 0; s < 64; ++s) {
         Piece pc = static_cast<Piece>(pieceOn[s]);
@@ -109,8 +163,6 @@ bool Position::set_fen(const std::string& fen) {
     hash ^= zobrist::CASTLING[castling & 0xF];
     if (ep != SQ_NONE) hash ^= zobrist::EP_FILE[file_of(ep)];
     if (stm == BLACK) hash ^= zobrist::SIDE_TO_MOVE;
-
-    return true;
 }
 
 void Position::put_piece(Piece pc, Square s) {
@@ -119,6 +171,9 @@ void Position::put_piece(Piece pc, Square s) {
     occByColor[2] |= Bit(s);
     pieceOn[s] = pc;
     hash ^= zobrist::PIECE_SQUARE[pc][s];
+    if (piece_type(pc) == PAWN) pawnHash ^= zobrist::PIECE_SQUARE[pc][s];
+    materialHash ^= zobrist::PIECE_SQUARE[pc][pieceCount[pc]++];
+    psq += eval::PSQ[pc][s];
 }
 
 void Position::remove_piece(Piece pc, Square s) {
@@ -127,6 +182,9 @@ void Position::remove_piece(Piece pc, Square s) {
     occByColor[2] &= ~Bit(s);
     pieceOn[s] = NO_PIECE;
     hash ^= zobrist::PIECE_SQUARE[pc][s];
+    if (piece_type(pc) == PAWN) pawnHash ^= zobrist::PIECE_SQUARE[pc][s];
+    materialHash ^= zobrist::PIECE_SQUARE[pc][--pieceCount[pc]];
+    psq -= eval::PSQ[pc][s];
 }
 
 void Position::move_piece(Piece pc, Square from, Square to) {
@@ -138,6 +196,8 @@ void Position::move_piece(Piece pc, Square from, Square to) {
     pieceOn[to] = pc;
     hash ^= zobrist::PIECE_SQUARE[pc][from];
     hash ^= zobrist::PIECE_SQUARE[pc][to];
+    if (piece_type(pc) == PAWN) pawnHash ^= zobrist::PIECE_SQUARE[pc][from] ^ zobrist::PIECE_SQUARE[pc][to];
+    psq += eval::PSQ[pc][to] - eval::PSQ[pc][from];
 }
 
 Square Position::king_square(Color c) const {
@@ -150,7 +210,7 @@ Square Position::king_square(Color c) const {
 
 bool Position::is_square_attacked(Square s, Color by) const {
     // Pawns
-    if (bitboard::PAWN_ATTACKS[by][s] & bbByPiece[make_piece(by, PAWN)]) return true;
+    if (bitboard::PAWN_ATTACKS[opposite(by)][s] & bbByPiece[make_piece(by, PAWN)]) return true;
     // Knights
     if (bitboard::KNIGHT_ATTACKS[s] & bbByPiece[make_piece(by, KNIGHT)]) return true;
     // King
@@ -164,7 +224,68 @@ bool Position::is_square_attacked(Square s, Color by) const {
     return false;
 }
 
-void Position::gen_pawn_moves(Color c, movegen::MoveList& list) const {
+U64 Position::attackers_to(Square s, U64 occ) const {
+    const U64 bishops = bbByPiece[W_BISHOP] | bbByPiece[B_BISHOP] | bbByPiece[W_QUEEN] | bbByPiece[B_QUEEN];
+    const U64 rooks = bbByPiece[W_ROOK] | bbByPiece[B_ROOK] | bbByPiece[W_QUEEN] | bbByPiece[B_QUEEN];
+    return (bitboard::PAWN_ATTACKS[BLACK][s] & bbByPiece[W_PAWN]) |
+           (bitboard::PAWN_ATTACKS[WHITE][s] & bbByPiece[B_PAWN]) |
+           (bitboard::KNIGHT_ATTACKS[s] & (bbByPiece[W_KNIGHT] | bbByPiece[B_KNIGHT])) |
+           (bitboard::KING_ATTACKS[s] & (bbByPiece[W_KING] | bbByPiece[B_KING])) |
+           (bitboard::sliding_attacks_bishop(s, occ) & bishops) |
+           (bitboard::sliding_attacks_rook(s, occ) & rooks);
+}
+
+bool Position::see_ge(movegen::Move m, int threshold) const {
+    // Castling and promotions are not exchanges worth resolving here.
+    if (movegen::is_kingside_castle(m) || movegen::is_queenside_castle(m) || movegen::is_promotion(m))
+        return 0 >= threshold;
+
+    const Square from = movegen::from_sq(m);
+    const Square to = movegen::to_sq(m);
+    U64 occ = occupancy() ^ Bit(from) ^ Bit(to);
+
+    int victim = 0;
+    if (movegen::is_enpassant(m)) {
+        victim = SEE_VALUE[PAWN];
+        occ ^= Bit(make_square(file_of(to), rank_of(from)));
+    } else if (pieceOn[to] != NO_PIECE) {
+        victim = SEE_VALUE[piece_type(static_cast<Piece>(pieceOn[to]))];
+    }
+
+    int swap = victim - threshold;
+    if (swap < 0) return false;
+    swap = SEE_VALUE[piece_type(static_cast<Piece>(pieceOn[from]))] - swap;
+    if (swap <= 0) return true;
+
+    const U64 bishops = bbByPiece[W_BISHOP] | bbByPiece[B_BISHOP] | bbByPiece[W_QUEEN] | bbByPiece[B_QUEEN];
+    const U64 rooks = bbByPiece[W_ROOK] | bbByPiece[B_ROOK] | bbByPiece[W_QUEEN] | bbByPiece[B_QUEEN];
+    U64 attackers = attackers_to(to, occ);
+    Color side = stm;
+    int res = 1;
+    while (true) {
+        side = opposite(side);
+        attackers &= occ;
+        const U64 sideAttackers = attackers & occByColor[side];
+        if (!sideAttackers) break;
+        res ^= 1;
+
+        // Capture with the least valuable attacker, then add x-rays behind it.
+        int pt = PAWN;
+        U64 bb = 0;
+        for (; pt <= KING; ++pt) {
+            bb = sideAttackers & bbByPiece[make_piece(side, static_cast<PieceType>(pt))];
+            if (bb) break;
+        }
+        if (pt == KING) return (attackers & ~occByColor[side]) ? (res ^ 1) != 0 : res != 0;
+        if ((swap = SEE_VALUE[pt] - swap) < res) break;
+        occ ^= bb & (0 - bb);
+        if (pt == PAWN || pt == BISHOP || pt == QUEEN) attackers |= bitboard::sliding_attacks_bishop(to, occ) & bishops;
+        if (pt == ROOK || pt == QUEEN) attackers |= bitboard::sliding_attacks_rook(to, occ) & rooks;
+    }
+    return res != 0;
+}
+
+void Position::gen_pawn_moves(Color c, movegen::MoveList& list, bool capturesOnly) const {
     const int dir = (c == WHITE) ? 1 : -1;
     const int startRank = (c == WHITE) ? 1 : 6;
     const int promoRank = (c == WHITE) ? 6 : 1;
@@ -179,7 +300,7 @@ void Position::gen_pawn_moves(Color c, movegen::MoveList& list) const {
         int nr = r + dir;
         if (nr >= 0 && nr < 8) {
             Square to = make_square(f, nr);
-            if (!(occupancy() & Bit(to))) {
+            if (!(occupancy() & Bit(to)) && (!capturesOnly || r == promoRank)) {
                 if (r == promoRank) {
                     list.add(movegen::make_move(from, to, 0, QUEEN));
                     list.add(movegen::make_move(from, to, 0, ROOK));
@@ -224,13 +345,13 @@ void Position::gen_pawn_moves(Color c, movegen::MoveList& list) const {
     }
 }
 
-void Position::gen_knight_moves(Color c, movegen::MoveList& list) const {
+void Position::gen_knight_moves(Color c, movegen::MoveList& list, bool capturesOnly) const {
     U64 knights = bbByPiece[make_piece(c, KNIGHT)];
-    U64 own = occByColor[c];
+    U64 targetMask = capturesOnly ? occByColor[opposite(c)] : ~occByColor[c];
     while (knights) {
         Square from = static_cast<Square>(__builtin_ctzll(knights));
         knights &= knights - 1;
-        U64 targets = bitboard::KNIGHT_ATTACKS[from] & ~own;
+        U64 targets = bitboard::KNIGHT_ATTACKS[from] & targetMask;
         while (targets) {
             Square to = static_cast<Square>(__builtin_ctzll(targets));
             targets &= targets - 1;
@@ -240,13 +361,13 @@ void Position::gen_knight_moves(Color c, movegen::MoveList& list) const {
     }
 }
 
-void Position::gen_bishop_moves(Color c, movegen::MoveList& list) const {
+void Position::gen_bishop_moves(Color c, movegen::MoveList& list, bool capturesOnly) const {
     U64 bishops = bbByPiece[make_piece(c, BISHOP)];
-    U64 own = occByColor[c];
+    U64 targetMask = capturesOnly ? occByColor[opposite(c)] : ~occByColor[c];
     while (bishops) {
         Square from = static_cast<Square>(__builtin_ctzll(bishops));
         bishops &= bishops - 1;
-        U64 targets = bitboard::sliding_attacks_bishop(from, occupancy()) & ~own;
+        U64 targets = bitboard::sliding_attacks_bishop(from, occupancy()) & targetMask;
         while (targets) {
             Square to = static_cast<Square>(__builtin_ctzll(targets));
             targets &= targets - 1;
@@ -256,13 +377,13 @@ void Position::gen_bishop_moves(Color c, movegen::MoveList& list) const {
     }
 }
 
-void Position::gen_rook_moves(Color c, movegen::MoveList& list) const {
+void Position::gen_rook_moves(Color c, movegen::MoveList& list, bool capturesOnly) const {
     U64 rooks = bbByPiece[make_piece(c, ROOK)];
-    U64 own = occByColor[c];
+    U64 targetMask = capturesOnly ? occByColor[opposite(c)] : ~occByColor[c];
     while (rooks) {
         Square from = static_cast<Square>(__builtin_ctzll(rooks));
         rooks &= rooks - 1;
-        U64 targets = bitboard::sliding_attacks_rook(from, occupancy()) & ~own;
+        U64 targets = bitboard::sliding_attacks_rook(from, occupancy()) & targetMask;
         while (targets) {
             Square to = static_cast<Square>(__builtin_ctzll(targets));
             targets &= targets - 1;
@@ -272,14 +393,14 @@ void Position::gen_rook_moves(Color c, movegen::MoveList& list) const {
     }
 }
 
-void Position::gen_queen_moves(Color c, movegen::MoveList& list) const {
+void Position::gen_queen_moves(Color c, movegen::MoveList& list, bool capturesOnly) const {
     U64 queens = bbByPiece[make_piece(c, QUEEN)];
-    U64 own = occByColor[c];
+    U64 targetMask = capturesOnly ? occByColor[opposite(c)] : ~occByColor[c];
     while (queens) {
         Square from = static_cast<Square>(__builtin_ctzll(queens));
         queens &= queens - 1;
         U64 targets = (bitboard::sliding_attacks_bishop(from, occupancy()) |
-                       bitboard::sliding_attacks_rook(from, occupancy())) & ~own;
+                       bitboard::sliding_attacks_rook(from, occupancy())) & targetMask;
         while (targets) {
             Square to = static_cast<Square>(__builtin_ctzll(targets));
             targets &= targets - 1;
@@ -289,17 +410,18 @@ void Position::gen_queen_moves(Color c, movegen::MoveList& list) const {
     }
 }
 
-void Position::gen_king_moves(Color c, movegen::MoveList& list) const {
+void Position::gen_king_moves(Color c, movegen::MoveList& list, bool capturesOnly) const {
     Square from = king_square(c);
     if (from == SQ_NONE) return;
-    U64 own = occByColor[c];
-    U64 targets = bitboard::KING_ATTACKS[from] & ~own;
+    U64 targetMask = capturesOnly ? occByColor[opposite(c)] : ~occByColor[c];
+    U64 targets = bitboard::KING_ATTACKS[from] & targetMask;
     while (targets) {
         Square to = static_cast<Square>(__builtin_ctzll(targets));
         targets &= targets - 1;
         bool cap = (occByColor[opposite(c)] & Bit(to)) != 0;
         list.add(movegen::make_move(from, to, cap ? movegen::CAPTURE : 0));
     }
+    if (capturesOnly) return;
     // Castling: simplified, no rook validation on squares; will enforce legality via checks
     if (c == WHITE) {
         if ((castling & 1) && !(occupancy() & (Bit(SQ_F1) | Bit(SQ_G1))) && !is_in_check(WHITE) &&
@@ -328,13 +450,23 @@ void Position::gen_pseudo_legal(movegen::MoveList& list) const {
     gen_king_moves(stm, list);
 }
 
+void Position::generate_captures(movegen::MoveList& list) const {
+    list.clear();
+    gen_pawn_moves(stm, list, true);
+    gen_knight_moves(stm, list, true);
+    gen_bishop_moves(stm, list, true);
+    gen_rook_moves(stm, list, true);
+    gen_queen_moves(stm, list, true);
+    gen_king_moves(stm, list, true);
+}
+
 void Position::generate_legal(movegen::MoveList& list) const {
     movegen::MoveList pseudo;
     gen_pseudo_legal(pseudo);
 
     list.clear();
     StateInfo st;
-    for (movegen::Move m : pseudo.moves) {
+    for (movegen::Move m : pseudo) {
         Position copy = *this;
         if (copy.make_move(m, st)) {
             list.add(m);
@@ -348,6 +480,7 @@ bool Position::make_move(movegen::Move m, StateInfo& st) {
     st.halfmoveClock = halfmove;
     st.hash = hash;
     st.captured = NO_PIECE;
+    st.dirty.count = 0;
 
     // Side to move out of hash
     hash ^= zobrist::SIDE_TO_MOVE;
@@ -373,11 +506,13 @@ bool Position::make_move(movegen::Move m, StateInfo& st) {
         if (piece_type(pc) != PAWN || capPc == NO_PIECE) return false;
         remove_piece(capPc, capSq);
         st.captured = capPc;
+        st.dirty.add(capPc, capSq, SQ_NONE);
         halfmove = 0;
     } else if (occByColor[opposite(stm)] & Bit(to)) {
         Piece capPc = static_cast<Piece>(pieceOn[to]);
         remove_piece(capPc, to);
         st.captured = capPc;
+        st.dirty.add(capPc, to, SQ_NONE);
         halfmove = 0;
     }
 
@@ -387,18 +522,22 @@ bool Position::make_move(movegen::Move m, StateInfo& st) {
         if (stm == WHITE) {
             if (pieceOn[SQ_H1] != W_ROOK) return false;
             move_piece(W_ROOK, SQ_H1, SQ_F1);
+            st.dirty.add(W_ROOK, SQ_H1, SQ_F1);
         } else {
             if (pieceOn[SQ_H8] != B_ROOK) return false;
             move_piece(B_ROOK, SQ_H8, SQ_F8);
+            st.dirty.add(B_ROOK, SQ_H8, SQ_F8);
         }
     } else if (movegen::is_queenside_castle(m)) {
         if (pc != make_piece(stm, KING)) return false;
         if (stm == WHITE) {
             if (pieceOn[SQ_A1] != W_ROOK) return false;
             move_piece(W_ROOK, SQ_A1, SQ_D1);
+            st.dirty.add(W_ROOK, SQ_A1, SQ_D1);
         } else {
             if (pieceOn[SQ_A8] != B_ROOK) return false;
             move_piece(B_ROOK, SQ_A8, SQ_D8);
+            st.dirty.add(B_ROOK, SQ_A8, SQ_D8);
         }
     }
 
@@ -413,6 +552,10 @@ bool Position::make_move(movegen::Move m, StateInfo& st) {
         PieceType pt = movegen::promotion_piece(m);
         remove_piece(pc, to);
         put_piece(make_piece(stm, pt), to);
+        st.dirty.add(pc, from, SQ_NONE);
+        st.dirty.add(make_piece(stm, pt), SQ_NONE, to);
+    } else {
+        st.dirty.add(pc, from, to);
     }
 
     // Double pawn push -> set ep
@@ -422,17 +565,8 @@ bool Position::make_move(movegen::Move m, StateInfo& st) {
     }
 
     // Update castling rights if moved through relevant squares (hash updates via castling table)
-    auto clear_castle = [&](Square s) {
-        if (s == SQ_E1) castling &= ~(1 | 2);
-        if (s == SQ_H1) castling &= ~1;
-        if (s == SQ_A1) castling &= ~2;
-        if (s == SQ_E8) castling &= ~(4 | 8);
-        if (s == SQ_H8) castling &= ~4;
-        if (s == SQ_A8) castling &= ~8;
-    };
     int oldCastling = st.castlingRights;
-    clear_castle(from);
-    clear_castle(to);
+    castling = castling_after(castling, from, to);
     if ((oldCastling & 0xF) != (castling & 0xF)) {
         hash ^= zobrist::CASTLING[oldCastling & 0xF];
         hash ^= zobrist::CASTLING[castling & 0xF];
@@ -443,6 +577,8 @@ bool Position::make_move(movegen::Move m, StateInfo& st) {
 
     // Legality: own king not in check
     if (is_in_check(stm)) {
+        // unmake_move expects the side to have been switched already
+        stm = opposite(stm);
         unmake_move(m, st);
         return false;
     }
@@ -452,13 +588,53 @@ bool Position::make_move(movegen::Move m, StateInfo& st) {
     return true;
 }
 
+U64 Position::key_after(movegen::Move m) const {
+    const Square from = movegen::from_sq(m);
+    const Square to = movegen::to_sq(m);
+    const Piece pc = static_cast<Piece>(pieceOn[from]);
+    if (pc == NO_PIECE) return hash;
+
+    U64 k = hash ^ zobrist::SIDE_TO_MOVE;
+    if (ep != SQ_NONE) k ^= zobrist::EP_FILE[file_of(ep)];
+
+    if (movegen::is_enpassant(m)) {
+        const Square capSq = make_square(file_of(to), rank_of(from));
+        k ^= zobrist::PIECE_SQUARE[make_piece(opposite(stm), PAWN)][capSq];
+    } else if (pieceOn[to] != NO_PIECE) {
+        k ^= zobrist::PIECE_SQUARE[pieceOn[to]][to];
+    }
+
+    if (movegen::is_kingside_castle(m)) {
+        const Piece rook = make_piece(stm, ROOK);
+        k ^= zobrist::PIECE_SQUARE[rook][stm == WHITE ? SQ_H1 : SQ_H8];
+        k ^= zobrist::PIECE_SQUARE[rook][stm == WHITE ? SQ_F1 : SQ_F8];
+    } else if (movegen::is_queenside_castle(m)) {
+        const Piece rook = make_piece(stm, ROOK);
+        k ^= zobrist::PIECE_SQUARE[rook][stm == WHITE ? SQ_A1 : SQ_A8];
+        k ^= zobrist::PIECE_SQUARE[rook][stm == WHITE ? SQ_D1 : SQ_D8];
+    }
+
+    k ^= zobrist::PIECE_SQUARE[pc][from];
+    if (movegen::is_promotion(m)) k ^= zobrist::PIECE_SQUARE[make_piece(stm, movegen::promotion_piece(m))][to];
+    else k ^= zobrist::PIECE_SQUARE[pc][to];
+
+    if (movegen::is_double_push(m) && piece_type(pc) == PAWN) k ^= zobrist::EP_FILE[file_of(from)];
+
+    const int newCastling = castling_after(castling, from, to);
+    if ((castling & 0xF) != (newCastling & 0xF)) {
+        k ^= zobrist::CASTLING[castling & 0xF];
+        k ^= zobrist::CASTLING[newCastling & 0xF];
+    }
+    return k;
+}
+
 void Position::unmake_move(movegen::Move m, const StateInfo& st) {
     // Restore base state
     stm = opposite(stm);
     castling = st.castlingRights;
     ep = st.epSquare;
     halfmove = st.halfmoveClock;
-    hash = st.hash;
+    if (stm == BLACK) --fullmove;
 
     Square from = movegen::from_sq(m);
     Square to = movegen::to_sq(m);
@@ -495,6 +671,11 @@ void Position::unmake_move(movegen::Move m, const StateInfo& st) {
             put_piece(st.captured, to);
         }
     }
+
+    // The piece helpers above have already reverted psq, the piece counts
+    // and the pawn and material keys, which they update exactly; they toggle
+    // the full key too, so restore the saved one last.
+    hash = st.hash;
 }
 
 bool Position::make_null_move(StateInfo& st) {
@@ -504,6 +685,7 @@ bool Position::make_null_move(StateInfo& st) {
     st.halfmoveClock = halfmove;
     st.hash = hash;
     st.captured = NO_PIECE;
+    st.dirty.count = 0;
     if (ep != SQ_NONE) hash ^= zobrist::EP_FILE[file_of(ep)];
     ep = SQ_NONE;
     hash ^= zobrist::SIDE_TO_MOVE;
@@ -529,7 +711,7 @@ bool Position::play_uci_move(const std::string& uci) {
 
     movegen::MoveList legal;
     generate_legal(legal);
-    for (auto m : legal.moves) {
+    for (auto m : legal) {
         if (movegen::from_sq(m) == from && movegen::to_sq(m) == to) {
             if (movegen::is_promotion(m)) {
                 if (uci.size() == 5) {
@@ -560,7 +742,7 @@ std::uint64_t Position::perft(int depth) {
     generate_legal(list);
     std::uint64_t nodes = 0;
     StateInfo st;
-    for (auto m : list.moves) {
+    for (auto m : list) {
         if (make_move(m, st)) {
             nodes += perft(depth - 1);
             unmake_move(m, st);
@@ -575,7 +757,7 @@ std::uint64_t Position::perft_divide(int depth, std::vector<std::pair<movegen::M
     generate_legal(list);
     std::uint64_t nodes = 0;
     StateInfo st;
-    for (auto m : list.moves) {
+    for (auto m : list) {
         if (make_move(m, st)) {
             std::uint64_t n = perft(depth - 1);
             out.emplace_back(m, n);
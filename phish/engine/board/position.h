@@ -7,17 +7,50 @@
 
 #include "engine/util/types.h"
 #include "engine/bitboard/bitboard.h"
+#include "engine/eval/psqt.h"
 #include "engine/movegen/move.h"
 #include "engine/util/zobrist.h"
 
 namespace phish::board {
 
+// Pieces a move took off, put on or moved, for incremental evaluators to
+// replay: `to` is SQ_NONE for a removed piece, `from` for an added one.
+struct DirtyPiece {
+    int count = 0;
+    Piece piece[3];
+    Square from[3];
+    Square to[3];
+
+    void add(Piece pc, Square f, Square t) {
+        piece[count] = pc;
+        from[count] = f;
+        to[count] = t;
+        ++count;
+    }
+};
+
 struct StateInfo {
     int castlingRights = 0; // bits: 1=K,2=Q,4=k,8=q
     Square epSquare = SQ_NONE;
     int halfmoveClock = 0;
     U64 hash = 0ULL;
     Piece captured = NO_PIECE;
+    DirtyPiece dirty;
+};
+
+// Fixed-size position record for bulk data, little-endian:
+//   0..7    occupancy bitboard
+//   8..23   Piece value of each occupied square from a1 upwards, 4 bits
+//           each, low nibble first
+//   24      bit 0 set if Black is to move; bits 1..4 castling rights
+//           (K, Q, k, q)
+//   25      en-passant square, 64 for none
+//   26      halfmove clock, capped at 255
+//   27      zero
+//   28..29  fullmove number
+//   30..31  zero
+struct PackedPosition {
+    unsigned char bytes[32] = {};
 };
 
 class Position {
@@ -26,17 +59,34 @@ public:
 
     bool set_fen(const std::string& fen);
     bool set_startpos();
+    // False for records that do not decode to a board, like set_fen.
+    bool set_packed(const PackedPosition& packed);
+    // False for boards with more than 32 men, which the record cannot hold.
+    bool pack(PackedPosition& packed) const;
 
     Color side_to_move() const { return stm; }
     int castling_rights() const { return castling; }
     Square ep_square() const { return ep; }
     U64 key() const { return hash; }
+    // Zobrist key of the pawns alone, for the pawn hash.
+    U64 pawn_key() const { return pawnHash; }
+    // Zobrist key of the piece counts, for the material hash.
+    U64 material_key() const { return materialHash; }
+    // Zobrist key of the position after a pseudo-legal move, without making it.
+    U64 key_after(movegen::Move m) const;
+    U64 key_after_null() const {
+        return hash ^ zobrist::SIDE_TO_MOVE ^ (ep != SQ_NONE ? zobrist::EP_FILE[file_of(ep)] : 0ULL);
+    }
 
     // Public queries for search/eval
     U64 pieces(Piece pc) const { return bbByPiece[pc]; }
     U64 color_bb(Color c) const { return occByColor[c]; }
     bool in_check() const { return is_in_check(stm); }
     int piece_at(Square s) const { return pieceOn[s]; }
+    int count(Piece pc) const { return pieceCount[pc]; }
+    // Material plus piece-square score from White's point of view, kept up
+    // to date by the piece helpers.
+    eval::Score psq_score() const { return psq; }
 
     // Make/unmake move. Returns false if move illegal.
     bool make_move(movegen::Move m, StateInfo& st);
@@ -48,6 +98,14 @@ public:
 
     // Generate legal moves into list
     void generate_legal(movegen::MoveList& list) const;
+    // Pseudo-legal captures and promotions for quiescence; make_move rejects
+    // the ones leaving the king in check.
+    void generate_captures(movegen::MoveList& list) const;
+
+    // Static exchange evaluation: true if the exchange started by m on its
+    // target square gains at least `threshold` centipawns.
+    bool see_ge(movegen::Move m, int threshold = 0) const;
+    U64 attackers_to(Square s, U64 occ) const;
 
     // Apply UCI move text (e2e4, e7e8q) to the position; returns false on failure
     bool play_uci_move(const std::string& uci);
@@ -68,10 +126,15 @@ private:
     int halfmove = 0;
     int fullmove = 1;
     U64 hash = 0ULL;
+    U64 pawnHash = 0ULL;
+    U64 materialHash = 0ULL;
+    int pieceCount[12]{};
+    eval::Score psq = 0;
 
     // Helpers
     U64 occupancy() const { return occByColor[2]; }
 
+    void compute_hash();
     bool is_square_attacked(Square s, Color by) const;
     Square king_square(Color c) const;
 
@@ -80,12 +143,12 @@ private:
     void move_piece(Piece pc, Square from, Square to);
 
     void gen_pseudo_legal(movegen::MoveList& list) const;
-    void gen_pawn_moves(Color c, movegen::MoveList& list) const;
-    void gen_knight_moves(Color c, movegen::MoveList& list) const;
-    void gen_bishop_moves(Color c, movegen::MoveList& list) const;
-    void gen_rook_moves(Color c, movegen::MoveList& list) const;
-    void gen_queen_moves(Color c, movegen::MoveList& list) const;
-    void gen_king_moves(Color c, movegen::MoveList& list) const;
+    void gen_pawn_moves(Color c, movegen::MoveList& list, bool capturesOnly = false) const;
+    void gen_knight_moves(Color c, movegen::MoveList& list, bool capturesOnly = false) const;
+    void gen_bishop_moves(Color c, movegen::MoveList& list, bool capturesOnly = false) const;
+    void gen_rook_moves(Color c, movegen::MoveList& list, bool capturesOnly = false) const;
+    void gen_queen_moves(Color c, movegen::MoveList& list, bool capturesOnly = false) const;
+    void gen_king_moves(Color c, movegen::MoveList& list, bool capturesOnly = false) const;
 
     bool is_in_check(Color c) const { return is_square_attacked(king_square(c), opposite(c)); }
 };
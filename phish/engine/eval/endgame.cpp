@@ -0,0 +1,193 @@
+#include "engine/eval/endgame.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "engine/bitboard/bitboard.h"
+#include "engine/util/zobrist.h"
+
+namespace phish::eval {
+
+namespace {
+
+constexpr U64 DARK_SQUARES = 0xAA55AA55AA55AA55ULL;
+
+constexpr int PIECE_VALUE[6] = {100, 320, 330, 500, 900, 0};
+
+Piece piece(Color c, PieceType pt) { return static_cast<Piece>(c * 6 + pt); }
+
+Square lsb_square(U64 b) { return static_cast<Square>(__builtin_ctzll(b)); }
+
+Square king_square(const board::Position& pos, Color c) { return lsb_square(pos.pieces(piece(c, KING))); }
+
+int distance(Square a, Square b) {
+    return std::max(std::abs(file_of(a) - file_of(b)), std::abs(rank_of(a) - rank_of(b)));
+}
+
+// 0 in the centre, 120 in a corner.
+int push_to_edge(Square s) {
+    const int f = std::min(file_of(s), 7 - file_of(s));
+    const int r = std::min(rank_of(s), 7 - rank_of(s));
+    return 20 * (3 - f) + 20 * (3 - r);
+}
+
+int push_close(Square a, Square b) { return 140 - 20 * distance(a, b); }
+
+int material(const board::Position& pos, Color c) {
+    int value = 0;
+    for (int pt = PAWN; pt <= QUEEN; ++pt) value += pos.count(piece(c, static_cast<PieceType>(pt))) * PIECE_VALUE[pt];
+    return value;
+}
+
+bool stalemated(const board::Position& pos, Color side) {
+    if (pos.side_to_move() != side || pos.in_check()) return false;
+    movegen::MoveList moves;
+    pos.generate_legal(moves);
+    return moves.size() == 0;
+}
+
+// The bishop drives the king into a corner of its own colour, where the
+// knight can help deliver mate.
+int eval_kbnk(const board::Position& pos, Color strong) {
+    const Square sk = king_square(pos, strong);
+    const Square wk = king_square(pos, opposite(strong));
+    const bool dark = (pos.pieces(piece(strong, BISHOP)) & DARK_SQUARES) != 0;
+    const int corner = dark ? std::min(distance(wk, SQ_A1), distance(wk, SQ_H8))
+                            : std::min(distance(wk, SQ_A8), distance(wk, SQ_H1));
+    return VALUE_KNOWN_WIN + PIECE_VALUE[KNIGHT] + PIECE_VALUE[BISHOP] + push_close(sk, wk) + 25 * (7 - corner);
+}
+
+int eval_knnk(const board::Position&, Color) { return 0; }
+
+// Drawish: only pushing the defending king to the edge gives chances.
+int eval_krkb(const board::Position& pos, Color strong) { return push_to_edge(king_square(pos, opposite(strong))); }
+
+// Also drawish, but a knight cut off from its king can be lost.
+int eval_krkn(const board::Position& pos, Color strong) {
+    const Color weak = opposite(strong);
+    const Square wk = king_square(pos, weak);
+    return push_to_edge(wk) + 10 * distance(wk, lsb_square(pos.pieces(piece(weak, KNIGHT))));
+}
+
+// Won in general, but slowly; the search needs the gradient.
+int eval_kqkr(const board::Position& pos, Color strong) {
+    const Square sk = king_square(pos, strong);
+    const Square wk = king_square(pos, opposite(strong));
+    return PIECE_VALUE[QUEEN] - PIECE_VALUE[ROOK] + push_to_edge(wk) + push_close(sk, wk);
+}
+
+int relative_rank(Color c, Square s) { return c == WHITE ? rank_of(s) : 7 - rank_of(s); }
+
+// Whether the defending king holds the queening corner of the strong side's
+// rook pawns: it is next to the corner already, or in front of every pawn
+// and nearer to the corner than the attacking king, counting the
+// attacker's tempo.
+bool holds_corner(const board::Position& pos, Color strong, Square queening) {
+    const Square sk = king_square(pos, strong);
+    const Square wk = king_square(pos, opposite(strong));
+    const int weakDistance = distance(wk, queening);
+    if (weakDistance <= 1) return true;
+    const U64 pawns = pos.pieces(piece(strong, PAWN));
+    const Square front = strong == WHITE ? static_cast<Square>(63 - __builtin_clzll(pawns)) : lsb_square(pawns);
+    const int tempo = pos.side_to_move() == strong ? 1 : 0;
+    return relative_rank(strong, wk) > relative_rank(strong, front) &&
+           weakDistance + tempo < distance(sk, queening);
+}
+
+// Material key of a signature such as "KBNK", the strong side's pieces
+// first, built the way Position builds it from the piece counts.
+U64 signature_key(const std::string& code, Color strong) {
+    const std::string letters = "PNBRQK";
+    const std::size_t split = code.find('K', 1);
+    U64 key = 0;
+    int counts[12] = {};
+    for (std::size_t i = 0; i < code.size(); ++i) {
+        const Color side = i < split ? strong : opposite(strong);
+        const Piece pc = piece(side, static_cast<PieceType>(letters.find(code[i])));
+        key ^= zobrist::PIECE_SQUARE[pc][counts[pc]++];
+    }
+    return key;
+}
+
+struct Registered {
+    U64 key;
+    Color strong;
+    EndgameEval fn;
+};
+
+const std::vector<Registered>& registry() {
+    static const std::vector<Registered> entries = [] {
+        const std::pair<const char*, EndgameEval> endgames[] = {
+            {"KBNK", eval_kbnk}, {"KNNK", eval_knnk}, {"KRKB", eval_krkb}, {"KRKN", eval_krkn}, {"KQKR", eval_kqkr},
+        };
+        std::vector<Registered> out;
+        for (const auto& [code, fn] : endgames)
+            for (const Color c : {WHITE, BLACK}) out.push_back(Registered{signature_key(code, c), c, fn});
+        return out;
+    }();
+    return entries;
+}
+
+} // namespace
+
+EndgameEval find_endgame(U64 materialKey, Color& strong) {
+    for (const Registered& r : registry()) {
+        if (r.key == materialKey) {
+            strong = r.strong;
+            return r.fn;
+        }
+    }
+    return nullptr;
+}
+
+// Mating material against a bare king: drive it to the edge and bring the
+// own king close. Without a certain mating force it is only a gradient.
+int eval_kxk(const board::Position& pos, Color strong) {
+    const Color weak = opposite(strong);
+    if (stalemated(pos, weak)) return 0;
+    const Square sk = king_square(pos, strong);
+    const Square wk = king_square(pos, weak);
+    int value = material(pos, strong) + push_to_edge(wk) + push_close(sk, wk);
+    const U64 bishops = pos.pieces(piece(strong, BISHOP));
+    if (pos.count(piece(strong, QUEEN)) || pos.count(piece(strong, ROOK)) ||
+        (bishops && pos.count(piece(strong, KNIGHT))) || ((bishops & DARK_SQUARES) && (bishops & ~DARK_SQUARES)))
+        value += VALUE_KNOWN_WIN;
+    return value;
+}
+
+// A rook pawn cannot win once the defending king holds the corner.
+int scale_kpk(const board::Position& pos, Color strong) {
+    const Square p = lsb_square(pos.pieces(piece(strong, PAWN)));
+    if (file_of(p) != 0 && file_of(p) != 7) return SCALE_NONE;
+    const Square queening = make_square(file_of(p), strong == WHITE ? 7 : 0);
+    return holds_corner(pos, strong, queening) ? SCALE_DRAW : SCALE_NONE;
+}
+
+// Rook pawns with a bishop that does not cover the queening square draw
+// when the defending king holds that corner.
+int scale_kbpsk(const board::Position& pos, Color strong) {
+    const U64 pawns = pos.pieces(piece(strong, PAWN));
+    const bool aFile = !(pawns & ~bitboard::FILE_A_BB);
+    const bool hFile = !(pawns & ~bitboard::FILE_H_BB);
+    if (!aFile && !hFile) return SCALE_NONE;
+    const Square queening = make_square(aFile ? 0 : 7, strong == WHITE ? 7 : 0);
+    const bool bishopDark = (pos.pieces(piece(strong, BISHOP)) & DARK_SQUARES) != 0;
+    const bool cornerDark = (Bit(queening) & DARK_SQUARES) != 0;
+    if (bishopDark == cornerDark) return SCALE_NONE;
+    return holds_corner(pos, strong, queening) ? SCALE_DRAW : SCALE_NONE;
+}
+
+// Bishops of opposite colours with only pawns besides: the defender blocks
+// on the squares the attacking bishop cannot touch, and an extra pawn is
+// rarely enough.
+int scale_opposite_bishops(const board::Position& pos, Color strong) {
+    const bool strongDark = (pos.pieces(piece(strong, BISHOP)) & DARK_SQUARES) != 0;
+    const bool weakDark = (pos.pieces(piece(opposite(strong), BISHOP)) & DARK_SQUARES) != 0;
+    if (strongDark == weakDark) return SCALE_NONE;
+    const int extraPawns = pos.count(piece(strong, PAWN)) - pos.count(piece(opposite(strong), PAWN));
+    return extraPawns <= 1 ? 16 : 32;
+}
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "engine/util/types.h"
+#include "engine/board/position.h"
+
+namespace phish::eval {
+
+// Score of a won ending, above any material balance the regular evaluation
+// produces and well below the mate scores.
+constexpr int VALUE_KNOWN_WIN = 10000;
+
+// Endgame scale factors multiply the endgame half of the score by
+// factor / SCALE_NORMAL. SCALE_NONE means the function has no opinion.
+constexpr int SCALE_DRAW = 0;
+constexpr int SCALE_NORMAL = 64;
+constexpr int SCALE_NONE = 255;
+
+// Both kinds of function take the side with the extra material and answer
+// from its point of view.
+using EndgameEval = int (*)(const board::Position& pos, Color strong);
+using EndgameScale = int (*)(const board::Position& pos, Color strong);
+
+// Evaluator registered for exactly this material key, with the side it
+// applies to; nullptr if there is none.
+EndgameEval find_endgame(U64 materialKey, Color& strong);
+
+// Bare king against enough material to mate.
+int eval_kxk(const board::Position& pos, Color strong);
+
+// Scaling functions for families of material signatures.
+int scale_kpk(const board::Position& pos, Color strong);
+int scale_kbpsk(const board::Position& pos, Color strong);
+int scale_opposite_bishops(const board::Position& pos, Color strong);
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "engine/eval/evaluate.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace phish::eval {
+
+namespace {
+
+Square king_square(const board::Position& pos, Color c) {
+    return static_cast<Square>(__builtin_ctzll(pos.pieces(static_cast<Piece>(c * 6 + KING))));
+}
+
+int endgame_value(const board::Position& pos, const MaterialEntry& me) {
+    const int value = me.evalFn(pos, me.evalStrong);
+    return pos.side_to_move() == me.evalStrong ? value : -value;
+}
+
+// Kept below the known wins, which only the endgame evaluators claim.
+int network_value(int value) { return std::clamp(value, -VALUE_KNOWN_WIN + 1, VALUE_KNOWN_WIN - 1); }
+
+// Material and pawn terms added to the incrementally kept piece-square
+// score, the endgame half scaled for drawish material, and the two halves
+// tapered by game phase.
+int classical(const board::Position& pos, EvalState& state, const MaterialEntry& me) {
+    PawnEntry& pe = state.pawns.probe(pos);
+    const Score total = pos.psq_score() + me.imbalance + pe.score + pe.king_shelter(WHITE, king_square(pos, WHITE)) -
+                        pe.king_shelter(BLACK, king_square(pos, BLACK));
+    const int mg = mg_value(total);
+    int eg = eg_value(total);
+    eg = eg * me.scale_factor(pos, eg > 0 ? WHITE : BLACK) / SCALE_NORMAL;
+    const int score = (mg * me.phase + eg * (PHASE_MAX - me.phase)) / PHASE_MAX;
+    return pos.side_to_move() == WHITE ? score : -score;
+}
+
+} // namespace
+
+// Known endings go to their own evaluator, everything else to the network
+// when one is loaded, or else to the classical evaluation.
+int evaluate(const board::Position& pos, EvalState& state) {
+    const MaterialEntry& me = state.material.probe(pos);
+    if (me.evalFn) return endgame_value(pos, me);
+    if (state.network) return network_value(nnue::evaluate(pos, *state.network, state.accumulators));
+    return classical(pos, state, me);
+}
+
+void evaluate_batch(std::span<const board::Position> positions, std::span<int> out, EvalState& state) {
+    assert(out.size() >= positions.size());
+    std::vector<const board::Position*> pending;
+    std::vector<std::size_t> slots;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        const board::Position& pos = positions[i];
+        const MaterialEntry& me = state.material.probe(pos);
+        if (me.evalFn) out[i] = endgame_value(pos, me);
+        else if (!state.network) out[i] = classical(pos, state, me);
+        else {
+            pending.push_back(&pos);
+            slots.push_back(i);
+        }
+    }
+    if (pending.empty()) return;
+
+    std::vector<int> values(pending.size());
+    nnue::evaluate_batch(pending.data(), static_cast<int>(pending.size()), *state.network, values.data());
+    for (std::size_t k = 0; k < pending.size(); ++k) out[slots[k]] = network_value(values[k]);
+}
+
+void evaluate_batch(std::span<const board::Position> positions, std::span<int> out) {
+    thread_local std::unique_ptr<EvalState> state;
+    if (!state) state = std::make_unique<EvalState>();
+    state->network = nnue::network();
+    evaluate_batch(positions, out, *state);
+}
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+
+#include "engine/board/position.h"
+#include "engine/eval/material.h"
+#include "engine/eval/nnue/nnue.h"
+#include "engine/eval/pawns.h"
+
+namespace phish::eval {
+
+// Per-thread evaluation state: the caches of the classical terms, and the
+// accumulators of the network when one is in use.
+struct EvalState {
+    PawnTable pawns;
+    MaterialTable material;
+    nnue::AccumulatorStack accumulators;
+    const nnue::Network* network = nullptr; // classical evaluation if null
+
+    void clear() {
+        pawns.clear();
+        material.clear();
+        accumulators.reset();
+    }
+};
+
+// Static evaluation in centipawns from the side to move's point of view.
+// With a network, `state.accumulators` must track the position: pushed
+// after every move made on it since the last reset().
+int evaluate(const board::Position& pos, EvalState& state);
+
+// evaluate() for many unrelated positions, such as training data: out[i]
+// receives the score of positions[i]. Network positions are refreshed from
+// the board and go through the layers in blocks; the results equal
+// evaluate()'s. The overload without a state uses one per calling thread
+// with the global network.
+void evaluate_batch(std::span<const board::Position> positions, std::span<int> out, EvalState& state);
+void evaluate_batch(std::span<const board::Position> positions, std::span<int> out);
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "engine/eval/material.h"
+
+#include <algorithm>
+
+#include "engine/eval/weights.h"
+
+namespace phish::eval {
+
+namespace {
+
+using namespace weights;
+
+constexpr int KNIGHT_VALUE = 320;
+constexpr int BISHOP_VALUE = 330;
+constexpr int ROOK_VALUE = 500;
+constexpr int QUEEN_VALUE = 900;
+
+int count(const board::Position& pos, Color c, PieceType pt) { return pos.count(static_cast<Piece>(c * 6 + pt)); }
+
+int non_pawn_material(const board::Position& pos, Color c) {
+    return count(pos, c, KNIGHT) * KNIGHT_VALUE + count(pos, c, BISHOP) * BISHOP_VALUE +
+           count(pos, c, ROOK) * ROOK_VALUE + count(pos, c, QUEEN) * QUEEN_VALUE;
+}
+
+Score imbalance(const board::Position& pos, Color c) {
+    const ImbalanceTerms t = imbalance_terms(pos, c);
+    return KNIGHT_PAWN_ADJUST * t.knightPawns + ROOK_PAWN_ADJUST * t.rookPawns + BISHOP_PAIR * t.bishopPair;
+}
+
+void compute(MaterialEntry& e, const board::Position& pos) {
+    int phase = 0;
+    for (int pc = 0; pc < 12; ++pc) phase += PHASE_WEIGHT[pc] * pos.count(static_cast<Piece>(pc));
+    e.phase = std::min(phase, PHASE_MAX);
+
+    // A registered signature, or mating material against a bare king, has
+    // its own evaluator and needs nothing else.
+    if ((e.evalFn = find_endgame(e.key, e.evalStrong))) return;
+    const int npm[COLOR_NB] = {non_pawn_material(pos, WHITE), non_pawn_material(pos, BLACK)};
+    const int pawns[COLOR_NB] = {count(pos, WHITE, PAWN), count(pos, BLACK, PAWN)};
+    for (const Color c : {WHITE, BLACK}) {
+        const Color weak = opposite(c);
+        if (npm[weak] == 0 && pawns[weak] == 0 && npm[c] >= ROOK_VALUE) {
+            e.evalFn = eval_kxk;
+            e.evalStrong = c;
+            return;
+        }
+    }
+
+    e.imbalance = imbalance(pos, WHITE) - imbalance(pos, BLACK);
+
+    const bool bishopsOnly = npm[WHITE] == BISHOP_VALUE && npm[BLACK] == BISHOP_VALUE &&
+                             count(pos, WHITE, BISHOP) == 1 && count(pos, BLACK, BISHOP) == 1;
+    for (const Color c : {WHITE, BLACK}) {
+        const Color weak = opposite(c);
+        if (npm[c] == 0 && npm[weak] == 0 && pawns[c] == 1 && pawns[weak] == 0) e.scaleFn[c] = scale_kpk;
+        else if (npm[c] == BISHOP_VALUE && count(pos, c, BISHOP) == 1 && pawns[c] > 0 && npm[weak] == 0)
+            e.scaleFn[c] = scale_kbpsk;
+        else if (bishopsOnly) e.scaleFn[c] = scale_opposite_bishops;
+
+        // Without pawns, a side needs more than a minor piece's worth of
+        // extra material to win.
+        if (pawns[c] == 0 && npm[c] - npm[weak] <= BISHOP_VALUE)
+            e.factor[c] = npm[c] < ROOK_VALUE ? SCALE_DRAW : npm[weak] <= BISHOP_VALUE ? 4 : 14;
+    }
+}
+
+} // namespace
+
+ImbalanceTerms imbalance_terms(const board::Position& pos, Color c) {
+    const int pawnsAboveFive = count(pos, c, PAWN) - 5;
+    ImbalanceTerms t;
+    t.knightPawns = count(pos, c, KNIGHT) * pawnsAboveFive;
+    t.rookPawns = count(pos, c, ROOK) * pawnsAboveFive;
+    t.bishopPair = count(pos, c, BISHOP) >= 2;
+    return t;
+}
+
+MaterialEntry& MaterialTable::probe(const board::Position& pos) {
+    const U64 key = pos.material_key();
+    MaterialEntry& e = entries[key & (SIZE - 1)];
+    if (e.key == key) return e;
+    e = MaterialEntry{};
+    e.key = key;
+    compute(e, pos);
+    return e;
+}
+
+void MaterialTable::clear() { std::fill(std::begin(entries), std::end(entries), MaterialEntry{}); }
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/util/types.h"
+#include "engine/board/position.h"
+#include "engine/eval/endgame.h"
+#include "engine/eval/psqt.h"
+
+namespace phish::eval {
+
+// How often each imbalance term applies to one side, for the tuner.
+struct ImbalanceTerms {
+    int knightPawns = 0; // knights times own pawns above five
+    int rookPawns = 0;   // rooks times own pawns above five
+    int bishopPair = 0;
+};
+
+ImbalanceTerms imbalance_terms(const board::Position& pos, Color c);
+
+// Everything that depends on the piece counts alone: imbalance terms, the
+// game phase and the endgame knowledge that applies. A specialised
+// evaluator replaces the regular evaluation; scaling functions and factors
+// only shrink its endgame half.
+struct MaterialEntry {
+    U64 key = 0;
+    Score imbalance = 0; // White's point of view
+    int phase = 0;       // 0..PHASE_MAX
+    EndgameEval evalFn = nullptr;
+    Color evalStrong = WHITE;
+    EndgameScale scaleFn[COLOR_NB] = {};
+    int factor[COLOR_NB] = {SCALE_NORMAL, SCALE_NORMAL};
+
+    // Scale factor for the endgame half when `c` is the side ahead there.
+    int scale_factor(const board::Position& pos, Color c) const {
+        if (scaleFn[c]) {
+            const int sf = scaleFn[c](pos, c);
+            if (sf != SCALE_NONE) return sf;
+        }
+        return factor[c];
+    }
+};
+
+// Direct-mapped material hash keyed by Position::material_key(), owned by
+// one searching thread. Endgame dispatch happens once per signature, on
+// the miss that fills the entry.
+class MaterialTable {
+public:
+    static constexpr std::size_t SIZE = 1 << 13;
+
+    // Entry for the material of `pos`, computed on a miss. The reference is
+    // valid until the next probe.
+    MaterialEntry& probe(const board::Position& pos);
+    void clear();
+
+private:
+    MaterialEntry entries[SIZE];
+};
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "engine/eval/nnue/nnue.h"
+
+// PHISH_EMBEDDED_NETWORK is the absolute path of the network file when the
+// build sets PHISH_EMBED_NETWORK. The assembler copies the file into
+// .rodata, 64-byte aligned like a mapped image, so it is paged in from the
+// binary on first use and shared by every process running it.
+#ifdef PHISH_EMBEDDED_NETWORK
+
+#if !defined(__ELF__)
+#error "PHISH_EMBED_NETWORK needs an ELF toolchain"
+#endif
+
+asm(".section .rodata\n"
+    ".balign 64\n"
+    ".globl phish_embedded_network_begin\n"
+    "phish_embedded_network_begin:\n"
+    ".incbin \"" PHISH_EMBEDDED_NETWORK "\"\n"
+    ".globl phish_embedded_network_end\n"
+    "phish_embedded_network_end:\n"
+    ".previous\n");
+
+extern "C" const unsigned char phish_embedded_network_begin[];
+extern "C" const unsigned char phish_embedded_network_end[];
+
+#endif
+
+namespace phish::eval::nnue {
+
+std::span<const unsigned char> embedded_image() {
+#ifdef PHISH_EMBEDDED_NETWORK
+    return {phish_embedded_network_begin, phish_embedded_network_end};
+#else
+    return {};
+#endif
+}
+
+} // namespace phish::eval::nnue
\ No newline at end of file
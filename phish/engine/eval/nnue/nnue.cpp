@@ -0,0 +1,370 @@
+#include "engine/eval/nnue/nnue.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+namespace phish::eval::nnue {
+
+namespace {
+
+constexpr char MAGIC[4] = {'P', 'H', 'N', 'N'};
+constexpr uint32_t VERSION = 2;
+constexpr std::size_t HEADER_BYTES = 64;
+// Positions evaluate_batch() takes through the layers together.
+constexpr int BATCH_BLOCK = 16;
+// Active features of one perspective: at most one per square. Set-up
+// positions may hold far more than the 32 men of a real game.
+constexpr int MAX_ACTIVE = 64;
+
+std::unique_ptr<Network> g_network;
+
+int orient(Color perspective, Square s) { return perspective == WHITE ? s : s ^ 56; }
+
+Square king_square(const board::Position& pos, Color c) {
+    return static_cast<Square>(__builtin_ctzll(pos.pieces(static_cast<Piece>(c * 6 + KING))));
+}
+
+// Byte offsets of the arrays in an image; each starts on a 64-byte
+// boundary, so a mapped file is as well aligned as a heap copy.
+struct Layout {
+    std::size_t ftBias, ftWeights, l1Bias, l1Weights, l2Bias, l2Weights, outBias, outWeights, total;
+};
+
+Layout layout(FeatureSet fs) {
+    std::size_t at = HEADER_BYTES;
+    auto take = [&at](std::size_t size) {
+        const std::size_t offset = at;
+        at = (at + size + 63) / 64 * 64;
+        return offset;
+    };
+    Layout l;
+    l.ftBias = take(HALF_DIMS * sizeof(int16_t));
+    l.ftWeights = take(static_cast<std::size_t>(feature_count(fs)) * HALF_DIMS * sizeof(int16_t));
+    l.l1Bias = take(L1_DIMS * sizeof(int32_t));
+    l.l1Weights = take(L1_DIMS * 2 * HALF_DIMS);
+    l.l2Bias = take(L2_DIMS * sizeof(int32_t));
+    l.l2Weights = take(L2_DIMS * L1_DIMS);
+    l.outBias = take(sizeof(int32_t));
+    l.outWeights = take(L2_DIMS);
+    l.total = at;
+    return l;
+}
+
+// Magic, then version, feature set and the three layer widths as uint32.
+void write_header(unsigned char* image, FeatureSet fs) {
+    const uint32_t fields[5] = {VERSION, static_cast<uint32_t>(fs), HALF_DIMS, L1_DIMS, L2_DIMS};
+    std::memcpy(image, MAGIC, sizeof(MAGIC));
+    std::memcpy(image + sizeof(MAGIC), fields, sizeof(fields));
+}
+
+// xorshift64*: plenty for test weights, and the same on every platform.
+struct Rng {
+    uint64_t s;
+    uint64_t next() {
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        return s * 2685821657736338717ULL;
+    }
+    int range(int lo, int hi) { return lo + static_cast<int>(next() % static_cast<uint64_t>(hi - lo + 1)); }
+};
+
+// Transformer rows of the active features of one perspective; at most
+// MAX_ACTIVE.
+int active_rows(const board::Position& pos, Color perspective, const Network& net, const int16_t** rows) {
+    const Square ksq = king_square(pos, perspective);
+    int count = 0;
+    for (int pc = 0; pc < 12; ++pc) {
+        for (U64 b = pos.pieces(static_cast<Piece>(pc)); b; b &= b - 1) {
+            const auto s = static_cast<Square>(__builtin_ctzll(b));
+            const int index = feature_index(net.features, perspective, ksq, static_cast<Piece>(pc), s);
+            if (index >= 0) rows[count++] = net.feature_row(index);
+        }
+    }
+    return count;
+}
+
+// Accumulator of one perspective computed from the board.
+void refresh(int16_t* values, Color perspective, const board::Position& pos, const Network& net, Simd simd) {
+    const int16_t* rows[MAX_ACTIVE];
+    const int count = active_rows(pos, perspective, net, rows);
+    update_rows(simd, values, net.ftBias, rows, count, nullptr, 0, HALF_DIMS);
+}
+
+// Clipped accumulators as the first layer's input. The side to move's half
+// comes first, so one set of layer weights serves both colours.
+void transform(const int16_t (&values)[COLOR_NB][HALF_DIMS], Color us, uint8_t* input, Simd simd) {
+    clamp_to_u8(simd, values[us], input, HALF_DIMS);
+    clamp_to_u8(simd, values[opposite(us)], input + HALF_DIMS, HALF_DIMS);
+}
+
+void clipped_relu(const int32_t* sums, uint8_t* out, int count) {
+    for (int i = 0; i < count; ++i) out[i] = static_cast<uint8_t>(std::clamp(sums[i] >> WEIGHT_SHIFT, 0, 127));
+}
+
+// The affine layers for up to BATCH_BLOCK transformed inputs stored back to
+// back; writes centipawns.
+void propagate(const Network& net, const uint8_t* input, int count, int* out, Simd simd) {
+    int32_t sums[BATCH_BLOCK * L1_DIMS];
+    alignas(64) uint8_t hidden1[BATCH_BLOCK * L1_DIMS];
+    alignas(64) uint8_t hidden2[BATCH_BLOCK * L2_DIMS];
+    int32_t output[BATCH_BLOCK];
+    affine_batch(simd, input, count, 2 * HALF_DIMS, net.l1Weights, net.l1Bias, sums, L1_DIMS);
+    clipped_relu(sums, hidden1, count * L1_DIMS);
+    affine_batch(simd, hidden1, count, L1_DIMS, net.l2Weights, net.l2Bias, sums, L2_DIMS);
+    clipped_relu(sums, hidden2, count * L2_DIMS);
+    affine_batch(simd, hidden2, count, L2_DIMS, net.outWeights, net.outBias, output, 1);
+    for (int i = 0; i < count; ++i) out[i] = output[i] / OUTPUT_SCALE;
+}
+
+template <typename T>
+void fill_random(unsigned char* image, std::size_t offset, std::size_t count, Rng& rng, int lo, int hi) {
+    T* values = reinterpret_cast<T*>(image + offset);
+    for (std::size_t i = 0; i < count; ++i) values[i] = static_cast<T>(rng.range(lo, hi));
+}
+
+} // namespace
+
+int feature_count(FeatureSet fs) { return fs == FeatureSet::HalfKP ? 64 * 10 * 64 : 64 * 12 * 64; }
+
+const char* feature_set_name(FeatureSet fs) { return fs == FeatureSet::HalfKP ? "HalfKP" : "HalfKA"; }
+
+int feature_index(FeatureSet fs, Color perspective, Square ksq, Piece pc, Square s) {
+    const int type = pc % 6;
+    const int kind = type * 2 + (pc / 6 != perspective ? 1 : 0);
+    if (fs == FeatureSet::HalfKP) {
+        if (type == KING) return -1;
+        return (orient(perspective, ksq) * 10 + kind) * 64 + orient(perspective, s);
+    }
+    return (orient(perspective, ksq) * 12 + kind) * 64 + orient(perspective, s);
+}
+
+Network::~Network() { memory::free_large(block); }
+
+bool Network::bind(std::string& error) {
+    uint32_t fields[5]; // version, feature set, layer widths
+    if (bytes < HEADER_BYTES || std::memcmp(base, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "not a phish network";
+        return false;
+    }
+    std::memcpy(fields, base + sizeof(MAGIC), sizeof(fields));
+    if (fields[0] != VERSION) {
+        error = "unsupported version " + std::to_string(fields[0]);
+        return false;
+    }
+    if (fields[1] > static_cast<uint32_t>(FeatureSet::HalfKA) || fields[2] != HALF_DIMS || fields[3] != L1_DIMS ||
+        fields[4] != L2_DIMS) {
+        error = "unsupported architecture";
+        return false;
+    }
+    features = static_cast<FeatureSet>(fields[1]);
+    const Layout l = layout(features);
+    if (bytes != l.total) {
+        error = "wrong size";
+        return false;
+    }
+    ftBias = reinterpret_cast<const int16_t*>(base + l.ftBias);
+    ftWeights = reinterpret_cast<const int16_t*>(base + l.ftWeights);
+    l1Bias = reinterpret_cast<const int32_t*>(base + l.l1Bias);
+    l1Weights = reinterpret_cast<const int8_t*>(base + l.l1Weights);
+    l2Bias = reinterpret_cast<const int32_t*>(base + l.l2Bias);
+    l2Weights = reinterpret_cast<const int8_t*>(base + l.l2Weights);
+    outBias = reinterpret_cast<const int32_t*>(base + l.outBias);
+    outWeights = reinterpret_cast<const int8_t*>(base + l.outWeights);
+    return true;
+}
+
+std::unique_ptr<Network> load(const std::string& path, std::string& error) {
+    if constexpr (std::endian::native != std::endian::little) {
+        error = "big-endian hosts are not supported";
+        return nullptr;
+    }
+    std::unique_ptr<Network> net(new Network());
+    if (path == EMBEDDED_NAME) {
+        const std::span<const unsigned char> image = embedded_image();
+        if (image.empty()) {
+            error = "no network is embedded in this build";
+            return nullptr;
+        }
+        net->storage = Network::Storage::Embedded;
+        net->base = image.data();
+        net->bytes = image.size();
+    } else {
+        if (!net->file.open(path, error)) return nullptr;
+        net->storage = net->file.mapped() ? Network::Storage::Mapped : Network::Storage::Heap;
+        net->base = net->file.data();
+        net->bytes = net->file.size();
+    }
+    if (!net->bind(error)) {
+        error = path + ": " + error;
+        return nullptr;
+    }
+    return net;
+}
+
+std::unique_ptr<Network> load_eval_file(const std::string& path, std::string& message) {
+    std::string error;
+    auto net = load(path, error);
+    std::string note;
+    if (!net && !embedded_image().empty()) {
+        note = " (" + error + ")";
+        net = load(EMBEDDED_NAME, error);
+    }
+    if (!net) {
+        message = "NNUE not loaded: " + error + "; using classical evaluation";
+        return nullptr;
+    }
+    message = std::string("NNUE ") + feature_set_name(net->features) + " " + storage_name(net->storage) + " " +
+              simd_name(best_simd()) + note;
+    return net;
+}
+
+bool save(const Network& net, const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(net.image()), static_cast<std::streamsize>(net.image_size()));
+    return static_cast<bool>(out);
+}
+
+const char* storage_name(Network::Storage storage) {
+    switch (storage) {
+        case Network::Storage::Mapped: return "mapped";
+        case Network::Storage::Embedded: return "embedded";
+        default: return "heap";
+    }
+}
+
+// Wide enough that accumulators leave 0..127 and the int8 weights span
+// their whole range, so the tests reach every clamp.
+std::unique_ptr<Network> random_network(FeatureSet fs, uint64_t seed) {
+    std::unique_ptr<Network> net(new Network());
+    const Layout l = layout(fs);
+    net->block = memory::allocate_large(l.total);
+    if (!net->block.ptr) return nullptr;
+    auto* image = static_cast<unsigned char*>(net->block.ptr);
+    std::memset(image, 0, l.total);
+    write_header(image, fs);
+
+    Rng rng{seed | 1};
+    fill_random<int16_t>(image, l.ftWeights, static_cast<std::size_t>(feature_count(fs)) * HALF_DIMS, rng, -64, 64);
+    fill_random<int16_t>(image, l.ftBias, HALF_DIMS, rng, -64, 128);
+    fill_random<int8_t>(image, l.l1Weights, L1_DIMS * 2 * HALF_DIMS, rng, -128, 127);
+    fill_random<int32_t>(image, l.l1Bias, L1_DIMS, rng, -4096, 4096);
+    fill_random<int8_t>(image, l.l2Weights, L2_DIMS * L1_DIMS, rng, -128, 127);
+    fill_random<int32_t>(image, l.l2Bias, L2_DIMS, rng, -1024, 1024);
+    fill_random<int8_t>(image, l.outWeights, L2_DIMS, rng, -128, 127);
+    fill_random<int32_t>(image, l.outBias, 1, rng, -256, 256);
+
+    net->base = image;
+    net->bytes = l.total;
+    std::string error;
+    net->bind(error);
+    return net;
+}
+
+void AccumulatorStack::reset() {
+    top = 0;
+    entries[0].computed[WHITE] = entries[0].computed[BLACK] = false;
+    entries[0].dirty.count = 0;
+}
+
+void AccumulatorStack::push(const board::DirtyPiece& dirty) {
+    Accumulator& next = entries[++top];
+    next.computed[WHITE] = next.computed[BLACK] = false;
+    next.dirty = dirty;
+}
+
+const Accumulator& AccumulatorStack::update(const board::Position& pos, const Network& net, Simd simd) {
+    Accumulator& current = entries[top];
+    for (const Color p : {WHITE, BLACK}) {
+        if (current.computed[p]) continue;
+
+        // Nearest computed ancestor reachable without a move of this
+        // perspective's king, which changes every feature index.
+        const Piece king = static_cast<Piece>(p * 6 + KING);
+        int base = top;
+        while (!entries[base].computed[p]) {
+            const board::DirtyPiece& d = entries[base].dirty;
+            if (base == 0 || std::find(d.piece, d.piece + d.count, king) != d.piece + d.count) break;
+            --base;
+        }
+        if (!entries[base].computed[p]) {
+            refresh(current.values[p], p, pos, net, simd);
+            current.computed[p] = true;
+            ++refreshes;
+            continue;
+        }
+
+        const Square ksq = king_square(pos, p);
+        for (int i = base + 1; i <= top; ++i) {
+            const board::DirtyPiece& d = entries[i].dirty;
+            const int16_t* added[3];
+            const int16_t* removed[3];
+            int addCount = 0;
+            int removeCount = 0;
+            for (int k = 0; k < d.count; ++k) {
+                if (d.from[k] != SQ_NONE) {
+                    const int index = feature_index(net.features, p, ksq, d.piece[k], d.from[k]);
+                    if (index >= 0) removed[removeCount++] = net.feature_row(index);
+                }
+                if (d.to[k] != SQ_NONE) {
+                    const int index = feature_index(net.features, p, ksq, d.piece[k], d.to[k]);
+                    if (index >= 0) added[addCount++] = net.feature_row(index);
+                }
+            }
+            update_rows(simd, entries[i].values[p], entries[i - 1].values[p], added, addCount, removed, removeCount,
+                        HALF_DIMS);
+            entries[i].computed[p] = true;
+            ++incremental;
+        }
+    }
+    return current;
+}
+
+int evaluate(const board::Position& pos, const Network& net, AccumulatorStack& stack, Simd simd) {
+    const Accumulator& acc = stack.update(pos, net, simd);
+    alignas(64) uint8_t input[2 * HALF_DIMS];
+    transform(acc.values, pos.side_to_move(), input, simd);
+    int value;
+    propagate(net, input, 1, &value, simd);
+    return value;
+}
+
+// Blocks of positions go through the layers together: each layer's inputs
+// for the whole block sit in one array, so every weight row is read once
+// per four positions instead of once per position.
+void evaluate_batch(const board::Position* const* positions, int count, const Network& net, int* out, Simd simd) {
+    alignas(64) int16_t values[COLOR_NB][HALF_DIMS];
+    alignas(64) uint8_t input[BATCH_BLOCK][2 * HALF_DIMS];
+    // Rows of the next position are fetched while the current one is summed.
+    const int16_t* rows[2][COLOR_NB][MAX_ACTIVE];
+    int rowCount[2][COLOR_NB] = {};
+    auto gather = [&](int i, int slot) {
+        for (const Color p : {WHITE, BLACK}) {
+            rowCount[slot][p] = active_rows(*positions[i], p, net, rows[slot][p]);
+            for (int k = 0; k < rowCount[slot][p]; ++k)
+                for (int line = 0; line < HALF_DIMS * 2; line += 64)
+                    __builtin_prefetch(reinterpret_cast<const char*>(rows[slot][p][k]) + line);
+        }
+    };
+    if (count > 0) gather(0, 0);
+    for (int first = 0; first < count; first += BATCH_BLOCK) {
+        const int n = std::min(BATCH_BLOCK, count - first);
+        for (int b = 0; b < n; ++b) {
+            const int i = first + b;
+            const int slot = i & 1;
+            if (i + 1 < count) gather(i + 1, slot ^ 1);
+            for (const Color p : {WHITE, BLACK})
+                update_rows(simd, values[p], net.ftBias, rows[slot][p], rowCount[slot][p], nullptr, 0, HALF_DIMS);
+            transform(values, positions[i]->side_to_move(), input[b], simd);
+        }
+        propagate(net, input[0], n, out + first, simd);
+    }
+}
+
+const Network* network() { return g_network.get(); }
+
+void set_network(std::unique_ptr<Network> net) { g_network = std::move(net); }
+
+} // namespace phish::eval::nnue
\ No newline at end of file
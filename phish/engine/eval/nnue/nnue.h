@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "engine/util/types.h"
+#include "engine/util/memory.h"
+#include "engine/board/position.h"
+#include "engine/eval/nnue/simd.h"
+
+namespace phish::eval::nnue {
+
+// Input features, both "king-relative": HalfKP indexes every piece except
+// the kings by its square and the perspective's own king square, HalfKA
+// indexes the kings too. Squares are flipped vertically for Black, so both
+// halves of the transformer share one set of weights.
+enum class FeatureSet : uint32_t { HalfKP = 0, HalfKA = 1 };
+
+// Feature transformer output per perspective, then two clipped-ReLU hidden
+// layers and a single output.
+constexpr int HALF_DIMS = 256;
+constexpr int L1_DIMS = 32;
+constexpr int L2_DIMS = 32;
+// Hidden-layer sums are shifted down by WEIGHT_SHIFT bits before clamping
+// to 0..127; the output is divided by OUTPUT_SCALE to give centipawns.
+constexpr int WEIGHT_SHIFT = 6;
+constexpr int OUTPUT_SCALE = 16;
+
+int feature_count(FeatureSet fs);
+const char* feature_set_name(FeatureSet fs);
+
+// Index of `pc` on `s` seen from `perspective`, whose king stands on `ksq`;
+// -1 if the set has no such feature (a king under HalfKP).
+int feature_index(FeatureSet fs, Color perspective, Square ksq, Piece pc, Square s);
+
+// Quantised weights: int16 for the feature transformer, int8 weights with
+// int32 biases for the affine layers, rows stored output by output.
+//
+// A network is a view of one flat little-endian image, the same bytes as
+// its file: a 64-byte header, then each array at a 64-byte offset. Loading
+// maps the file read-only instead of copying it, so every engine process
+// on a host shares one copy of the weights in the page cache.
+class Network {
+public:
+    enum class Storage { Heap, Mapped, Embedded };
+
+    ~Network();
+    Network(const Network&) = delete;
+    Network& operator=(const Network&) = delete;
+
+    FeatureSet features = FeatureSet::HalfKP;
+    Storage storage = Storage::Heap;
+    const int16_t* ftBias = nullptr;
+    const int16_t* ftWeights = nullptr; // [feature_count][HALF_DIMS]
+    const int32_t* l1Bias = nullptr;
+    const int8_t* l1Weights = nullptr; // [L1_DIMS][2 * HALF_DIMS]
+    const int32_t* l2Bias = nullptr;
+    const int8_t* l2Weights = nullptr; // [L2_DIMS][L1_DIMS]
+    const int32_t* outBias = nullptr;
+    const int8_t* outWeights = nullptr; // [L2_DIMS]
+
+    const int16_t* feature_row(int index) const { return ftWeights + static_cast<std::size_t>(index) * HALF_DIMS; }
+
+    // The whole image, as save() writes it.
+    const unsigned char* image() const { return base; }
+    std::size_t image_size() const { return bytes; }
+
+private:
+    friend std::unique_ptr<Network> load(const std::string& path, std::string& error);
+    friend std::unique_ptr<Network> random_network(FeatureSet fs, uint64_t seed);
+
+    Network() = default;
+    // Checks the header of the image and points the arrays into it.
+    bool bind(std::string& error);
+
+    const unsigned char* base = nullptr;
+    std::size_t bytes = 0;
+    memory::MappedFile file;  // owns a loaded image
+    memory::LargeBlock block; // owns a generated image
+};
+
+// EvalFile value that selects the network compiled into the binary with the
+// PHISH_EMBED_NETWORK build option.
+inline constexpr const char* EMBEDDED_NAME = "<embedded>";
+// That image, empty in builds without one.
+std::span<const unsigned char> embedded_image();
+
+// Maps a network file, or takes the embedded image for EMBEDDED_NAME.
+// Returns nullptr and the reason in `error` when the file is missing or
+// malformed.
+std::unique_ptr<Network> load(const std::string& path, std::string& error);
+bool save(const Network& net, const std::string& path);
+
+// The network an EvalFile setting names, or the embedded one when that
+// file cannot be used; nullptr if neither works. `message` describes the
+// outcome in one line for the user.
+std::unique_ptr<Network> load_eval_file(const std::string& path, std::string& message);
+const char* storage_name(Network::Storage storage);
+
+// Small random weights from a fixed seed, for tests and benchmarks.
+std::unique_ptr<Network> random_network(FeatureSet fs, uint64_t seed);
+
+struct Accumulator {
+    alignas(64) int16_t values[COLOR_NB][HALF_DIMS];
+    bool computed[COLOR_NB];
+    board::DirtyPiece dirty; // the move from the entry below to this one
+};
+
+// One accumulator per ply of the line being searched: push() after every
+// successful make_move or null move, pop() at its unmake. Nothing is
+// computed until an evaluation asks; then each perspective is brought up to
+// date from its nearest computed ancestor, or refreshed from the board when
+// its own king has moved in between.
+class AccumulatorStack {
+public:
+    static constexpr int CAPACITY = 256;
+
+    // Starts a new line at the current position.
+    void reset();
+    void push(const board::DirtyPiece& dirty);
+    void pop() { --top; }
+
+    const Accumulator& update(const board::Position& pos, const Network& net, Simd simd);
+
+    uint64_t refreshes = 0;
+    uint64_t incremental = 0;
+
+private:
+    Accumulator entries[CAPACITY];
+    int top = 0;
+};
+
+// Network output in centipawns from the side to move's point of view.
+int evaluate(const board::Position& pos, const Network& net, AccumulatorStack& stack, Simd simd = best_simd());
+
+// Evaluates `count` unrelated positions, each refreshed from the board,
+// with the same results as evaluate().
+void evaluate_batch(const board::Position* const* positions, int count, const Network& net, int* out,
+                    Simd simd = best_simd());
+
+// The network the search evaluates with, or nullptr for the classical
+// evaluation. Only swapped while no search runs.
+const Network* network();
+void set_network(std::unique_ptr<Network> net);
+
+} // namespace phish::eval::nnue
\ No newline at end of file
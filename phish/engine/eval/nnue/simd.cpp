@@ -0,0 +1,254 @@
+#include "engine/eval/nnue/simd.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PHISH_NNUE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace phish::eval::nnue {
+
+namespace {
+
+void update_rows_scalar(int16_t* out, const int16_t* in, const int16_t* const* add, int addCount,
+                        const int16_t* const* sub, int subCount, int dims) {
+    for (int j = 0; j < dims; ++j) {
+        int v = in[j];
+        for (int k = 0; k < addCount; ++k) v += add[k][j];
+        for (int k = 0; k < subCount; ++k) v -= sub[k][j];
+        // Wraps like the 16-bit vector lanes do.
+        out[j] = static_cast<int16_t>(v);
+    }
+}
+
+void clamp_to_u8_scalar(const int16_t* in, uint8_t* out, int dims) {
+    for (int j = 0; j < dims; ++j) out[j] = static_cast<uint8_t>(std::clamp<int>(in[j], 0, 127));
+}
+
+void affine_scalar(const uint8_t* in, int inDims, const int8_t* weights, const int32_t* bias, int32_t* out,
+                   int outDims) {
+    for (int o = 0; o < outDims; ++o) {
+        const int8_t* row = weights + o * inDims;
+        int32_t sum = bias[o];
+        for (int i = 0; i < inDims; ++i) sum += in[i] * row[i];
+        out[o] = sum;
+    }
+}
+
+#ifdef PHISH_NNUE_X86
+
+__attribute__((target("avx2"))) void update_rows_avx2(int16_t* out, const int16_t* in, const int16_t* const* add,
+                                                      int addCount, const int16_t* const* sub, int subCount,
+                                                      int dims) {
+    for (int j = 0; j < dims; j += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + j));
+        for (int k = 0; k < addCount; ++k)
+            v = _mm256_add_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(add[k] + j)));
+        for (int k = 0; k < subCount; ++k)
+            v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sub[k] + j)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j), v);
+    }
+}
+
+__attribute__((target("avx2"))) void clamp_to_u8_avx2(const int16_t* in, uint8_t* out, int dims) {
+    const __m256i zero = _mm256_setzero_si256();
+    for (int j = 0; j < dims; j += 32) {
+        const __m256i a = _mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + j)), zero);
+        const __m256i b = _mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + j + 16)), zero);
+        // packs works per 128-bit lane; the permute restores input order.
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0b11011000);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j), packed);
+    }
+}
+
+__attribute__((target("avx2"))) int32_t hsum_avx2(__m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0b01001110));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0b10110001));
+    return _mm_cvtsi128_si32(sum);
+}
+
+// u8 x s8 products of 32 byte pairs, summed into eight int32 lanes.
+__attribute__((target("avx2"))) __m256i dot_avx2(__m256i acc, const uint8_t* x, __m256i w) {
+    const __m256i products = _mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x)), w);
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(products, _mm256_set1_epi16(1)));
+}
+
+__attribute__((target("avx2"))) void affine_avx2(const uint8_t* in, int inDims, const int8_t* weights,
+                                                 const int32_t* bias, int32_t* out, int outDims) {
+    for (int o = 0; o < outDims; ++o) {
+        const int8_t* row = weights + o * inDims;
+        __m256i acc = _mm256_setzero_si256();
+        for (int i = 0; i < inDims; i += 32)
+            acc = dot_avx2(acc, in + i, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)));
+        out[o] = bias[o] + hsum_avx2(acc);
+    }
+}
+
+__attribute__((target("avx2"))) void affine4_avx2(const uint8_t* in, int inDims, const int8_t* weights,
+                                                  const int32_t* bias, int32_t* out, int outDims) {
+    const uint8_t* in1 = in + inDims;
+    const uint8_t* in2 = in1 + inDims;
+    const uint8_t* in3 = in2 + inDims;
+    for (int o = 0; o < outDims; ++o) {
+        const int8_t* row = weights + o * inDims;
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        for (int i = 0; i < inDims; i += 32) {
+            const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+            acc0 = dot_avx2(acc0, in + i, w);
+            acc1 = dot_avx2(acc1, in1 + i, w);
+            acc2 = dot_avx2(acc2, in2 + i, w);
+            acc3 = dot_avx2(acc3, in3 + i, w);
+        }
+        out[o] = bias[o] + hsum_avx2(acc0);
+        out[outDims + o] = bias[o] + hsum_avx2(acc1);
+        out[2 * outDims + o] = bias[o] + hsum_avx2(acc2);
+        out[3 * outDims + o] = bias[o] + hsum_avx2(acc3);
+    }
+}
+
+__attribute__((target("ssse3"))) void update_rows_ssse3(int16_t* out, const int16_t* in, const int16_t* const* add,
+                                                        int addCount, const int16_t* const* sub, int subCount,
+                                                        int dims) {
+    for (int j = 0; j < dims; j += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + j));
+        for (int k = 0; k < addCount; ++k)
+            v = _mm_add_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(add[k] + j)));
+        for (int k = 0; k < subCount; ++k)
+            v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(sub[k] + j)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j), v);
+    }
+}
+
+__attribute__((target("ssse3"))) void clamp_to_u8_ssse3(const int16_t* in, uint8_t* out, int dims) {
+    const __m128i zero = _mm_setzero_si128();
+    for (int j = 0; j < dims; j += 16) {
+        const __m128i a = _mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + j)), zero);
+        const __m128i b = _mm_max_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + j + 8)), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j), _mm_packs_epi16(a, b));
+    }
+}
+
+__attribute__((target("ssse3"))) int32_t hsum_ssse3(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0b01001110));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0b10110001));
+    return _mm_cvtsi128_si32(v);
+}
+
+__attribute__((target("ssse3"))) __m128i dot_ssse3(__m128i acc, const uint8_t* x, __m128i w) {
+    const __m128i products = _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)), w);
+    return _mm_add_epi32(acc, _mm_madd_epi16(products, _mm_set1_epi16(1)));
+}
+
+__attribute__((target("ssse3"))) void affine_ssse3(const uint8_t* in, int inDims, const int8_t* weights,
+                                                   const int32_t* bias, int32_t* out, int outDims) {
+    for (int o = 0; o < outDims; ++o) {
+        const int8_t* row = weights + o * inDims;
+        __m128i acc = _mm_setzero_si128();
+        for (int i = 0; i < inDims; i += 16)
+            acc = dot_ssse3(acc, in + i, _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)));
+        out[o] = bias[o] + hsum_ssse3(acc);
+    }
+}
+
+__attribute__((target("ssse3"))) void affine4_ssse3(const uint8_t* in, int inDims, const int8_t* weights,
+                                                    const int32_t* bias, int32_t* out, int outDims) {
+    const uint8_t* in1 = in + inDims;
+    const uint8_t* in2 = in1 + inDims;
+    const uint8_t* in3 = in2 + inDims;
+    for (int o = 0; o < outDims; ++o) {
+        const int8_t* row = weights + o * inDims;
+        __m128i acc0 = _mm_setzero_si128(), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        for (int i = 0; i < inDims; i += 16) {
+            const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            acc0 = dot_ssse3(acc0, in + i, w);
+            acc1 = dot_ssse3(acc1, in1 + i, w);
+            acc2 = dot_ssse3(acc2, in2 + i, w);
+            acc3 = dot_ssse3(acc3, in3 + i, w);
+        }
+        out[o] = bias[o] + hsum_ssse3(acc0);
+        out[outDims + o] = bias[o] + hsum_ssse3(acc1);
+        out[2 * outDims + o] = bias[o] + hsum_ssse3(acc2);
+        out[3 * outDims + o] = bias[o] + hsum_ssse3(acc3);
+    }
+}
+
+#endif
+
+} // namespace
+
+Simd best_simd() {
+    static const Simd best = [] {
+        if (simd_supported(Simd::AVX2)) return Simd::AVX2;
+        if (simd_supported(Simd::SSSE3)) return Simd::SSSE3;
+        return Simd::Scalar;
+    }();
+    return best;
+}
+
+bool simd_supported(Simd simd) {
+#ifdef PHISH_NNUE_X86
+    __builtin_cpu_init();
+    switch (simd) {
+        case Simd::AVX2: return __builtin_cpu_supports("avx2");
+        case Simd::SSSE3: return __builtin_cpu_supports("ssse3");
+        default: return true;
+    }
+#else
+    return simd == Simd::Scalar;
+#endif
+}
+
+const char* simd_name(Simd simd) {
+    switch (simd) {
+        case Simd::AVX2: return "avx2";
+        case Simd::SSSE3: return "ssse3";
+        default: return "scalar";
+    }
+}
+
+void update_rows(Simd simd, int16_t* out, const int16_t* in, const int16_t* const* add, int addCount,
+                 const int16_t* const* sub, int subCount, int dims) {
+#ifdef PHISH_NNUE_X86
+    if (simd == Simd::AVX2) return update_rows_avx2(out, in, add, addCount, sub, subCount, dims);
+    if (simd == Simd::SSSE3) return update_rows_ssse3(out, in, add, addCount, sub, subCount, dims);
+#endif
+    update_rows_scalar(out, in, add, addCount, sub, subCount, dims);
+}
+
+void clamp_to_u8(Simd simd, const int16_t* in, uint8_t* out, int dims) {
+#ifdef PHISH_NNUE_X86
+    if (simd == Simd::AVX2) return clamp_to_u8_avx2(in, out, dims);
+    if (simd == Simd::SSSE3) return clamp_to_u8_ssse3(in, out, dims);
+#endif
+    clamp_to_u8_scalar(in, out, dims);
+}
+
+void affine(Simd simd, const uint8_t* in, int inDims, const int8_t* weights, const int32_t* bias, int32_t* out,
+            int outDims) {
+#ifdef PHISH_NNUE_X86
+    if (simd == Simd::AVX2) return affine_avx2(in, inDims, weights, bias, out, outDims);
+    if (simd == Simd::SSSE3) return affine_ssse3(in, inDims, weights, bias, out, outDims);
+#endif
+    affine_scalar(in, inDims, weights, bias, out, outDims);
+}
+
+void affine_batch(Simd simd, const uint8_t* in, int count, int inDims, const int8_t* weights, const int32_t* bias,
+                  int32_t* out, int outDims) {
+    int n = 0;
+#ifdef PHISH_NNUE_X86
+    for (; simd != Simd::Scalar && n + 4 <= count; n += 4) {
+        const uint8_t* x = in + static_cast<std::size_t>(n) * inDims;
+        int32_t* y = out + static_cast<std::size_t>(n) * outDims;
+        if (simd == Simd::AVX2) affine4_avx2(x, inDims, weights, bias, y, outDims);
+        else affine4_ssse3(x, inDims, weights, bias, y, outDims);
+    }
+#endif
+    for (; n < count; ++n)
+        affine(simd, in + static_cast<std::size_t>(n) * inDims, inDims, weights, bias,
+               out + static_cast<std::size_t>(n) * outDims, outDims);
+}
+
+} // namespace phish::eval::nnue
\ No newline at end of file
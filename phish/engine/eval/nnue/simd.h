@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+namespace phish::eval::nnue {
+
+// Instruction sets the inference kernels are written for. Every path gives
+// bit-identical results: the int16 accumulator arithmetic wraps the same
+// way, and the int8 dot products cannot saturate because activations are
+// clamped to 0..127 before they reach them.
+enum class Simd { Scalar, SSSE3, AVX2 };
+
+// Best path this CPU supports; kernels are compiled for each x86 target
+// and chosen at run time, so the build needs no -march flag.
+Simd best_simd();
+bool simd_supported(Simd simd);
+const char* simd_name(Simd simd);
+
+// out = in + the `addCount` rows of `add` - the `subCount` rows of `sub`,
+// each `dims` int16 values long. `out` may alias `in`.
+void update_rows(Simd simd, int16_t* out, const int16_t* in, const int16_t* const* add, int addCount,
+                 const int16_t* const* sub, int subCount, int dims);
+
+// Clamps `dims` int16 values to 0..127.
+void clamp_to_u8(Simd simd, const int16_t* in, uint8_t* out, int dims);
+
+// out[o] = bias[o] + sum over i of in[i] * weights[o * inDims + i]. `inDims`
+// is a multiple of 32 and every input is at most 127.
+void affine(Simd simd, const uint8_t* in, int inDims, const int8_t* weights, const int32_t* bias, int32_t* out,
+            int outDims);
+
+// affine() for `count` inputs stored one after another, writing `outDims`
+// sums per input. Each weight row is loaded once for four inputs.
+void affine_batch(Simd simd, const uint8_t* in, int count, int inDims, const int8_t* weights, const int32_t* bias,
+                  int32_t* out, int outDims);
+
+} // namespace phish::eval::nnue
\ No newline at end of file
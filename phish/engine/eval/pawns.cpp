@@ -0,0 +1,133 @@
+#include "engine/eval/pawns.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "engine/bitboard/bitboard.h"
+#include "engine/eval/weights.h"
+
+namespace phish::eval {
+
+namespace {
+
+using namespace bitboard;
+using namespace weights;
+
+constexpr int popcount(U64 b) { return __builtin_popcountll(b); }
+
+inline int relative_rank(Color c, Square s) { return c == WHITE ? rank_of(s) : 7 - rank_of(s); }
+
+constexpr U64 push(Color c, U64 b) { return c == WHITE ? shift_north(b) : shift_south(b); }
+
+// Squares strictly in front of `b` from c's point of view.
+constexpr U64 front_span(Color c, U64 b) {
+    return c == WHITE ? north_fill(shift_north(b)) : south_fill(shift_south(b));
+}
+
+constexpr U64 adjacent_files(U64 b) {
+    const U64 files = file_fill(b);
+    return shift_east(files) | shift_west(files);
+}
+
+// Pawns of c that no enemy pawn can stop; the opponent's attack span
+// must already be set.
+U64 passed_pawns(const PawnEntry& e, Color c) {
+    const Color them = opposite(c);
+    const U64 us = e.pawns[c];
+    const U64 doubled = us & front_span(them, us);
+    return us & ~front_span(them, e.pawns[them]) & ~doubled & ~e.attackSpan[them];
+}
+
+Score structure_score(const PawnTerms& t) {
+    Score score = DOUBLED * t.doubled + ISOLATED * t.isolated + BACKWARD * t.backward;
+    for (int r = 0; r < 8; ++r) score += PASSED[r] * t.passed[r] + CANDIDATE[r] * t.candidate[r];
+    return score;
+}
+
+} // namespace
+
+PawnTerms PawnEntry::terms(Color c) const {
+    const Color them = opposite(c);
+    const U64 us = pawns[c];
+    const U64 theirs = pawns[them];
+
+    const U64 doubled = us & front_span(them, us); // an own pawn further up the file
+    const U64 isolated = us & ~adjacent_files(us);
+    const U64 open = us & ~front_span(them, theirs) & ~doubled;
+    // Stop square attacked by an enemy pawn and out of reach of own pawns.
+    const U64 backward = push(them, push(c, us) & attacks[them] & ~attackSpan[c]) & ~isolated;
+
+    PawnTerms t;
+    t.doubled = popcount(doubled);
+    t.isolated = popcount(isolated);
+    t.backward = popcount(backward);
+    for (U64 b = passed[c]; b; b &= b - 1) ++t.passed[relative_rank(c, static_cast<Square>(__builtin_ctzll(b)))];
+
+    // Candidates: open, not yet passed, and with at least as many own pawns
+    // level or behind on the adjacent files as enemy sentries ahead on them.
+    for (U64 b = open & ~passed[c]; b; b &= b - 1) {
+        const Square s = static_cast<Square>(__builtin_ctzll(b));
+        const U64 adjacent = adjacent_files(Bit(s));
+        const U64 span = front_span(c, Bit(s));
+        const U64 ahead = shift_east(span) | shift_west(span);
+        if (popcount(us & adjacent & ~ahead) >= popcount(theirs & ahead)) ++t.candidate[relative_rank(c, s)];
+    }
+    return t;
+}
+
+ShelterTerms PawnEntry::shelter_terms(Color c, Square ksq) const {
+    const int kingFile = file_of(ksq);
+    // Own pawns on or in front of the king's rank.
+    const U64 kingRank = RANK_MASKS[rank_of(ksq)];
+    const U64 inFront = pawns[c] & (c == WHITE ? north_fill(kingRank) : south_fill(kingRank));
+    ShelterTerms t;
+    for (int f = std::max(kingFile - 1, 0); f <= std::min(kingFile + 1, 7); ++f) {
+        const U64 onFile = inFront & FILE_MASKS[f];
+        if (!onFile) {
+            ++t.missing;
+            continue;
+        }
+        const Square nearest =
+            static_cast<Square>(c == WHITE ? __builtin_ctzll(onFile) : 63 - __builtin_clzll(onFile));
+        ++t.distance[std::min(std::abs(rank_of(nearest) - rank_of(ksq)), 3)];
+    }
+    return t;
+}
+
+Score PawnEntry::compute_shelter(Color c, Square ksq) const {
+    const ShelterTerms t = shelter_terms(c, ksq);
+    Score bonus = SHELTER_MISSING * t.missing;
+    for (int d = 0; d < 4; ++d) bonus += SHELTER_DISTANCE[d] * t.distance[d];
+    return bonus;
+}
+
+PawnEntry& PawnTable::probe(const board::Position& pos) {
+    const U64 key = pos.pawn_key();
+    PawnEntry& e = entries[key & (SIZE - 1)];
+    ++probes;
+    if (e.key == key) {
+        ++hits;
+        return e;
+    }
+
+    e = PawnEntry{};
+    e.key = key;
+    for (int c = WHITE; c <= BLACK; ++c) {
+        const Color side = static_cast<Color>(c);
+        e.pawns[c] = pos.pieces(static_cast<Piece>(c * 6 + PAWN));
+        e.attacks[c] = pawn_attacks(side, e.pawns[c]);
+        e.attackSpan[c] = side == WHITE ? north_fill(e.attacks[c]) : south_fill(e.attacks[c]);
+    }
+    e.passed[WHITE] = passed_pawns(e, WHITE);
+    e.passed[BLACK] = passed_pawns(e, BLACK);
+    e.score = structure_score(e.terms(WHITE)) - structure_score(e.terms(BLACK));
+    return e;
+}
+
+void PawnTable::clear() {
+    std::fill(std::begin(entries), std::end(entries), PawnEntry{});
+    probes = 0;
+    hits = 0;
+}
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/util/types.h"
+#include "engine/board/position.h"
+#include "engine/eval/psqt.h"
+
+namespace phish::eval {
+
+// How often each structure term applies to one side's pawns. A score is
+// these counts times the weights; the tuner fits the weights to them.
+struct PawnTerms {
+    int doubled = 0;
+    int isolated = 0;
+    int backward = 0;
+    int passed[8] = {};    // by relative rank
+    int candidate[8] = {}; // by relative rank
+};
+
+// The king shelter's terms: the rank distance of the nearest own pawn in
+// front of the king on each of its and the adjacent files, or a missing one.
+struct ShelterTerms {
+    int distance[4] = {}; // 3 and more share the last entry
+    int missing = 0;
+};
+
+// Everything derived from one pawn configuration. The structure score and
+// bitboards depend on the pawns alone; the king shelter also depends on the
+// king square, so it is computed on demand and kept until that king moves.
+struct PawnEntry {
+    U64 key = 0;
+    Score score = 0; // structure terms, White's point of view
+    U64 pawns[COLOR_NB] = {};
+    U64 passed[COLOR_NB] = {};
+    U64 attacks[COLOR_NB] = {};
+    U64 attackSpan[COLOR_NB] = {}; // squares the pawns attack now or after advancing
+    Square kingSquare[COLOR_NB] = {SQ_NONE, SQ_NONE};
+    Score shelter[COLOR_NB] = {}; // for kingSquare, from that side's point of view
+
+    Score king_shelter(Color c, Square ksq) {
+        if (kingSquare[c] != ksq) {
+            kingSquare[c] = ksq;
+            shelter[c] = compute_shelter(c, ksq);
+        }
+        return shelter[c];
+    }
+
+    // Counts behind score and shelter, from c's point of view.
+    PawnTerms terms(Color c) const;
+    ShelterTerms shelter_terms(Color c, Square ksq) const;
+
+private:
+    Score compute_shelter(Color c, Square ksq) const;
+};
+
+// Direct-mapped pawn hash keyed by the pawn-only Zobrist key, owned by one
+// searching thread. An empty slot (key 0) is already the correct entry for
+// a pawnless position.
+class PawnTable {
+public:
+    static constexpr std::size_t SIZE = 1 << 13;
+
+    // Entry for the pawns of `pos`, computed on a miss. The reference is
+    // valid until the next probe.
+    PawnEntry& probe(const board::Position& pos);
+    void clear();
+
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+
+private:
+    PawnEntry entries[SIZE];
+};
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "engine/eval/psqt.h"
+
+#include "engine/eval/weights.h"
+
+namespace phish::eval {
+
+namespace {
+
+using namespace weights;
+
+constexpr const int* MG_TABLES[6] = {MG_PAWN, MG_KNIGHT, MG_BISHOP, MG_ROOK, MG_QUEEN, MG_KING};
+constexpr const int* EG_TABLES[6] = {EG_PAWN, EG_KNIGHT, EG_BISHOP, EG_ROOK, EG_QUEEN, EG_KING};
+
+// A white piece on square s reads row (s ^ 56) of the printed table; a black
+// one reads row s, which is its own square seen from the other side.
+constexpr auto build_psq() {
+    std::array<std::array<Score, 64>, 12> psq{};
+    for (int pt = 0; pt < 6; ++pt) {
+        for (int s = 0; s < 64; ++s) {
+            const Score white = make_score(MG_VALUE[pt] + MG_TABLES[pt][s ^ 56], EG_VALUE[pt] + EG_TABLES[pt][s ^ 56]);
+            const Score black = make_score(MG_VALUE[pt] + MG_TABLES[pt][s], EG_VALUE[pt] + EG_TABLES[pt][s]);
+            psq[pt][s] = white;
+            psq[pt + 6][s] = -black;
+        }
+    }
+    return psq;
+}
+
+} // namespace
+
+const std::array<std::array<Score, 64>, 12> PSQ = build_psq();
+
+const int PHASE_WEIGHT[12] = {0, 1, 1, 2, 4, 0, 0, 1, 1, 2, 4, 0};
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "engine/util/types.h"
+
+namespace phish::eval {
+
+// A middlegame and an endgame value packed into one int32, eg in the upper
+// and mg in the lower 16 bits, so both are added and subtracted by a single
+// integer operation. The packing is exact as long as either half stays
+// within int16.
+using Score = int32_t;
+
+constexpr Score make_score(int mg, int eg) {
+    return static_cast<Score>(static_cast<uint32_t>(eg) << 16) + mg;
+}
+
+constexpr int mg_value(Score s) { return static_cast<int16_t>(static_cast<uint16_t>(static_cast<uint32_t>(s))); }
+
+constexpr int eg_value(Score s) {
+    return static_cast<int16_t>(static_cast<uint16_t>((static_cast<uint32_t>(s) + 0x8000u) >> 16));
+}
+
+// Game phase: 24 with all minor and major pieces on the board, 0 with none.
+constexpr int PHASE_MAX = 24;
+
+// Material plus piece-square value of each piece on each square, from
+// White's point of view (black entries are mirrored and negated).
+extern const std::array<std::array<Score, 64>, 12> PSQ;
+
+// Game-phase weight of each piece.
+extern const int PHASE_WEIGHT[12];
+
+} // namespace phish::eval
\ No newline at end of file
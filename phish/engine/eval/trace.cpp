@@ -0,0 +1,189 @@
+#include "engine/eval/trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "engine/eval/weights.h"
+
+namespace phish::eval {
+
+namespace {
+
+using namespace weights;
+
+constexpr const int* MG_TABLES[6] = {MG_PAWN, MG_KNIGHT, MG_BISHOP, MG_ROOK, MG_QUEEN, MG_KING};
+constexpr const int* EG_TABLES[6] = {EG_PAWN, EG_KNIGHT, EG_BISHOP, EG_ROOK, EG_QUEEN, EG_KING};
+
+const char* const PIECE_NAMES[6] = {"PAWN", "KNIGHT", "BISHOP", "ROOK", "QUEEN", "KING"};
+
+struct Weights {
+    int mg[WEIGHT_NB];
+    int eg[WEIGHT_NB];
+};
+
+const Weights& compiled() {
+    static const Weights w = [] {
+        Weights init;
+        current_weights(init.mg, init.eg);
+        return init;
+    }();
+    return w;
+}
+
+void set(int* mg, int* eg, int index, Score s) {
+    mg[index] = mg_value(s);
+    eg[index] = eg_value(s);
+}
+
+// Adds one side's terms to `coeffs` with the given sign.
+void add_side(int* coeffs, const board::Position& pos, PawnEntry& pe, Color c, int sign) {
+    for (int pt = PAWN; pt <= KING; ++pt) {
+        for (U64 b = pos.pieces(static_cast<Piece>(c * 6 + pt)); b; b &= b - 1) {
+            const int s = __builtin_ctzll(b);
+            coeffs[W_VALUE + pt] += sign;
+            coeffs[W_PSQT + pt * 64 + (c == WHITE ? s ^ 56 : s)] += sign;
+        }
+    }
+
+    const PawnTerms pt = pe.terms(c);
+    coeffs[W_DOUBLED] += sign * pt.doubled;
+    coeffs[W_ISOLATED] += sign * pt.isolated;
+    coeffs[W_BACKWARD] += sign * pt.backward;
+    for (int r = 0; r < 8; ++r) {
+        coeffs[W_PASSED + r] += sign * pt.passed[r];
+        coeffs[W_CANDIDATE + r] += sign * pt.candidate[r];
+    }
+
+    const Square ksq = static_cast<Square>(__builtin_ctzll(pos.pieces(static_cast<Piece>(c * 6 + KING))));
+    const ShelterTerms st = pe.shelter_terms(c, ksq);
+    for (int d = 0; d < 4; ++d) coeffs[W_SHELTER_DISTANCE + d] += sign * st.distance[d];
+    coeffs[W_SHELTER_MISSING] += sign * st.missing;
+
+    const ImbalanceTerms it = imbalance_terms(pos, c);
+    coeffs[W_KNIGHT_PAWN_ADJUST] += sign * it.knightPawns;
+    coeffs[W_ROOK_PAWN_ADJUST] += sign * it.rookPawns;
+    coeffs[W_BISHOP_PAIR] += sign * it.bishopPair;
+}
+
+} // namespace
+
+void current_weights(int mg[WEIGHT_NB], int eg[WEIGHT_NB]) {
+    for (int pt = 0; pt < 6; ++pt) {
+        mg[W_VALUE + pt] = MG_VALUE[pt];
+        eg[W_VALUE + pt] = EG_VALUE[pt];
+        for (int s = 0; s < 64; ++s) {
+            mg[W_PSQT + pt * 64 + s] = MG_TABLES[pt][s];
+            eg[W_PSQT + pt * 64 + s] = EG_TABLES[pt][s];
+        }
+    }
+    set(mg, eg, W_DOUBLED, DOUBLED);
+    set(mg, eg, W_ISOLATED, ISOLATED);
+    set(mg, eg, W_BACKWARD, BACKWARD);
+    for (int r = 0; r < 8; ++r) {
+        set(mg, eg, W_PASSED + r, PASSED[r]);
+        set(mg, eg, W_CANDIDATE + r, CANDIDATE[r]);
+    }
+    for (int d = 0; d < 4; ++d) set(mg, eg, W_SHELTER_DISTANCE + d, SHELTER_DISTANCE[d]);
+    set(mg, eg, W_SHELTER_MISSING, SHELTER_MISSING);
+    set(mg, eg, W_BISHOP_PAIR, BISHOP_PAIR);
+    set(mg, eg, W_KNIGHT_PAWN_ADJUST, KNIGHT_PAWN_ADJUST);
+    set(mg, eg, W_ROOK_PAWN_ADJUST, ROOK_PAWN_ADJUST);
+}
+
+bool trace(const board::Position& pos, EvalState& state, EvalTrace& out) {
+    const MaterialEntry& me = state.material.probe(pos);
+    if (me.evalFn) return false;
+    PawnEntry& pe = state.pawns.probe(pos);
+
+    int coeffs[WEIGHT_NB] = {};
+    add_side(coeffs, pos, pe, WHITE, 1);
+    add_side(coeffs, pos, pe, BLACK, -1);
+    out.terms.clear();
+    for (int i = 0; i < WEIGHT_NB; ++i)
+        if (coeffs[i]) out.terms.push_back({static_cast<uint16_t>(i), static_cast<int16_t>(coeffs[i])});
+
+    // The scale factor depends on which side the endgame sum favours.
+    int egSum = 0;
+    for (const TraceTerm& t : out.terms) egSum += t.coeff * compiled().eg[t.index];
+    out.phase = me.phase;
+    out.scale = me.scale_factor(pos, egSum > 0 ? WHITE : BLACK);
+    return true;
+}
+
+int traced_value(const EvalTrace& t, const int* mg, const int* eg) {
+    int mgSum = 0, egSum = 0;
+    for (const TraceTerm& term : t.terms) {
+        mgSum += term.coeff * mg[term.index];
+        egSum += term.coeff * eg[term.index];
+    }
+    egSum = egSum * t.scale / SCALE_NORMAL;
+    return (mgSum * t.phase + egSum * (PHASE_MAX - t.phase)) / PHASE_MAX;
+}
+
+std::string weights_header(const int* mg, const int* eg) {
+    std::string out;
+    char buf[128];
+    auto score = [&](int index) {
+        std::snprintf(buf, sizeof(buf), "make_score(%d, %d)", mg[index], eg[index]);
+        return std::string(buf);
+    };
+    auto scalar = [&](const char* name, int index) {
+        out += std::string("constexpr Score ") + name + " = " + score(index) + ";\n";
+    };
+    auto array = [&](const char* name, int index, int size) {
+        out += std::string("constexpr Score ") + name + "[" + std::to_string(size) + "] = {\n";
+        for (int i = 0; i < size; i += 4) {
+            out += "    ";
+            const int last = std::min(i + 4, size) - 1;
+            for (int j = i; j <= last; ++j) out += score(index + j) + (j < last ? ", " : ",");
+            out += "\n";
+        }
+        out += "};\n";
+    };
+    auto values = [&](const char* name, const int* w) {
+        out += std::string("constexpr int ") + name + "[6] = {";
+        for (int pt = 0; pt < 6; ++pt) out += std::to_string(w[W_VALUE + pt]) + (pt < 5 ? ", " : "};\n");
+    };
+
+    out += "#pragma once\n\n#include \"engine/eval/psqt.h\"\n\n";
+    out += "// Weights of the classical evaluation. phish_tune writes this file from\n"
+           "// labelled positions, in this layout.\n\n";
+    out += "namespace phish::eval::weights {\n\n";
+    values("MG_VALUE", mg);
+    values("EG_VALUE", eg);
+    out += "\n// Piece-square bonuses, laid out as the board is printed: rank 8 first, A\n// to H within a rank.\n";
+    for (const int* w : {mg, eg}) {
+        for (int pt = 0; pt < 6; ++pt) {
+            out += std::string("constexpr int ") + (w == mg ? "MG_" : "EG_") + PIECE_NAMES[pt] + "[64] = {\n";
+            for (int rank = 0; rank < 8; ++rank) {
+                out += "    ";
+                for (int file = 0; file < 8; ++file) {
+                    const int value = w[W_PSQT + pt * 64 + rank * 8 + file];
+                    std::snprintf(buf, sizeof(buf), "%4d%s", value, file < 7 ? ", " : ",");
+                    out += buf;
+                }
+                out += "\n";
+            }
+            out += "};\n\n";
+        }
+    }
+    out += "// Pawn structure, per pawn.\n";
+    scalar("DOUBLED", W_DOUBLED);
+    scalar("ISOLATED", W_ISOLATED);
+    scalar("BACKWARD", W_BACKWARD);
+    out += "// By relative rank.\n";
+    array("PASSED", W_PASSED, 8);
+    array("CANDIDATE", W_CANDIDATE, 8);
+    out += "\n// King shelter: the own pawn closest in front of the king on each of the\n"
+           "// king's and adjacent files, by rank distance, or a missing one.\n";
+    array("SHELTER_DISTANCE", W_SHELTER_DISTANCE, 4);
+    scalar("SHELTER_MISSING", W_SHELTER_MISSING);
+    out += "\n// Imbalance: the bishop pair, and per knight or rook per own pawn above five.\n";
+    scalar("BISHOP_PAIR", W_BISHOP_PAIR);
+    scalar("KNIGHT_PAWN_ADJUST", W_KNIGHT_PAWN_ADJUST);
+    scalar("ROOK_PAWN_ADJUST", W_ROOK_PAWN_ADJUST);
+    out += "\n} // namespace phish::eval::weights";
+    return out;
+}
+
+} // namespace phish::eval
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/board/position.h"
+#include "engine/eval/evaluate.h"
+
+namespace phish::eval {
+
+// The classical evaluation as a linear function of its weights, for the
+// tuner. Each weight is a (middlegame, endgame) pair at a fixed place in
+// one flat vector, in the order weights.h lists them.
+enum WeightIndex : int {
+    W_VALUE = 0,                                // by piece type
+    W_PSQT = W_VALUE + 6,                       // by piece type, then printed-table square
+    W_DOUBLED = W_PSQT + 6 * 64,
+    W_ISOLATED,
+    W_BACKWARD,
+    W_PASSED,                                   // by relative rank
+    W_CANDIDATE = W_PASSED + 8,                 // by relative rank
+    W_SHELTER_DISTANCE = W_CANDIDATE + 8,       // by rank distance
+    W_SHELTER_MISSING = W_SHELTER_DISTANCE + 4,
+    W_BISHOP_PAIR,
+    W_KNIGHT_PAWN_ADJUST,
+    W_ROOK_PAWN_ADJUST,
+    WEIGHT_NB
+};
+
+// The weights this build was compiled with, in that layout.
+void current_weights(int mg[WEIGHT_NB], int eg[WEIGHT_NB]);
+
+struct TraceTerm {
+    uint16_t index;
+    int16_t coeff;
+};
+
+// One position's coefficients. White's middlegame and endgame sums are
+// coeff * weight over `terms`; evaluate() then scales the endgame sum by
+// scale / SCALE_NORMAL and tapers the two by phase.
+struct EvalTrace {
+    std::vector<TraceTerm> terms; // non-zero coefficients, White minus Black
+    int phase = 0;
+    int scale = SCALE_NORMAL;
+};
+
+// False for positions a specialised endgame evaluator scores, which do not
+// depend on the weights. The scale factor is the one the compiled weights
+// select, and is then held fixed.
+bool trace(const board::Position& pos, EvalState& state, EvalTrace& out);
+
+// Evaluation under the given weights, from White's point of view, rounded
+// as evaluate() rounds: for the compiled weights it equals the classical
+// evaluate() of the traced position.
+int traced_value(const EvalTrace& t, const int* mg, const int* eg);
+
+// weights.h as it would read with the given weights.
+std::string weights_header(const int* mg, const int* eg);
+
+} // namespace phish::eval
\ No newline at end of file
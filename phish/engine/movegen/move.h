@@ -1,7 +1,7 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <vector>
 
 #include "engine/util/types.h"
 
@@ -20,12 +20,12 @@ enum MoveFlags : std::uint32_t {
 };
 
 inline Move make_move(Square from, Square to, std::uint32_t flags = 0, PieceType promo = NO_PIECE_TYPE) {
-    // bits: 0-5 from, 6-11 to, 12-14 promo(3 bits), 14.. flags (overlap ok since PROMO guard)
+    // bits: 0-5 from, 6-11 to, 12-13 promo (piece - KNIGHT), 14.. flags
     std::uint32_t m = 0;
     m |= static_cast<std::uint32_t>(from);
     m |= static_cast<std::uint32_t>(to) << 6;
     if (promo != NO_PIECE_TYPE) {
-        m |= (static_cast<std::uint32_t>(promo) & 0x7) << 12;
+        m |= (static_cast<std::uint32_t>(promo - KNIGHT) & 0x3) << 12;
         m |= PROMOTION;
     }
     m |= flags;
@@ -40,15 +40,21 @@ inline bool is_double_push(Move m) { return (m & DOUBLE_PUSH) != 0; }
 inline bool is_kingside_castle(Move m) { return (m & KING_CASTLE) != 0; }
 inline bool is_queenside_castle(Move m) { return (m & QUEEN_CASTLE) != 0; }
 inline bool is_promotion(Move m) { return (m & PROMOTION) != 0; }
-inline PieceType promotion_piece(Move m) { return static_cast<PieceType>((m >> 12) & 0x7); }
+inline PieceType promotion_piece(Move m) { return static_cast<PieceType>(KNIGHT + ((m >> 12) & 0x3)); }
 
+constexpr std::size_t MAX_MOVES = 256;
+
+// Fixed-capacity move list; lives on the stack so search never allocates.
+// `scores` holds per-move ordering keys filled in once by the search.
 struct MoveList {
-    std::vector<Move> moves;
-    void clear() { moves.clear(); }
-    void add(Move m) { moves.push_back(m); }
-    std::size_t size() const { return moves.size(); }
-    const Move* begin() const { return moves.data(); }
-    const Move* end() const { return moves.data() + moves.size(); }
+    Move moves[MAX_MOVES];
+    int scores[MAX_MOVES];
+    std::size_t count = 0;
+    void clear() { count = 0; }
+    void add(Move m) { moves[count++] = m; }
+    std::size_t size() const { return count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
 };
 
 } // namespace phish::movegen
\ No newline at end of file
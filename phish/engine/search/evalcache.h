@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "engine/util/types.h"
+
+namespace phish::search {
+
+// Direct-mapped cache of static evals keyed by the full Zobrist key, owned
+// by one searching thread. It catches the quiescence positions whose TT
+// entries were never written or have already been replaced.
+struct EvalCache {
+    static constexpr std::size_t SIZE = 1 << 14;
+
+    struct Entry {
+        U64 key;
+        int16_t eval;
+    };
+
+    Entry entries[SIZE];
+
+    bool probe(U64 key, int& eval) const {
+        const Entry& e = entries[key & (SIZE - 1)];
+        if (e.key != key) return false;
+        eval = e.eval;
+        return true;
+    }
+
+    void store(U64 key, int eval) { entries[key & (SIZE - 1)] = Entry{key, static_cast<int16_t>(eval)}; }
+
+    void clear() { std::memset(static_cast<void*>(entries), 0, sizeof(entries)); }
+};
+
+} // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "engine/util/types.h"
+#include "engine/movegen/move.h"
+#include "engine/search/search.h"
+
+namespace phish::search {
+
+constexpr int HISTORY_MAX = 16384;
+
+// Gravity update: large bonuses move the entry quickly, but it saturates
+// smoothly at +-HISTORY_MAX instead of overflowing or needing periodic aging.
+inline void update_history(int16_t& entry, int bonus) {
+    bonus = std::clamp(bonus, -HISTORY_MAX, HISTORY_MAX);
+    entry = static_cast<int16_t>(entry + bonus - entry * std::abs(bonus) / HISTORY_MAX);
+}
+
+inline int history_bonus(int depth) { return std::min(32 * depth * depth + 64 * depth, 2400); }
+
+// Move-ordering statistics owned by one searching thread.
+struct Heuristics {
+    movegen::Move killers[MAX_PLY + 1][2];
+    // [previous moved piece][previous to-square] -> refutation
+    movegen::Move counterMoves[12][64];
+    // [side to move][from][to]
+    int16_t butterfly[COLOR_NB][64][64];
+    // [moved piece][to][captured piece type, NO_PIECE_TYPE for quiet promotions]
+    int16_t captureHistory[12][64][PIECE_TYPE_NB + 1];
+    // [previous piece][previous to][piece][to]
+    int16_t continuation[12][64][12][64];
+
+    void clear() { std::memset(static_cast<void*>(this), 0, sizeof(*this)); }
+    void clear_killers() { std::memset(killers, 0, sizeof(killers)); }
+};
+
+} // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "engine/search/mate.h"
+
+#include <algorithm>
+
+namespace phish::search {
+
+namespace {
+
+constexpr uint32_t PN_INFINITE = 1u << 30;
+
+constexpr uint64_t TIME_CHECK_INTERVAL = 1024;
+
+// Entries for the same position at different remaining depths must not
+// share a key.
+inline U64 depth_key(U64 key, int plies) { return key ^ (static_cast<U64>(plies + 1) * 0x9E3779B97F4A7C15ULL); }
+
+} // namespace
+
+MateSolver::MateSolver(std::size_t hashMb) {
+    const std::size_t bytes = std::max<std::size_t>(hashMb, 1) * 1024 * 1024;
+    std::size_t count = BUCKET_SIZE;
+    while (count * 2 * sizeof(Entry) <= bytes) count *= 2;
+    table.assign(count, Entry{});
+    mask = (count - 1) & ~static_cast<std::size_t>(BUCKET_SIZE - 1);
+}
+
+void MateSolver::clear() { std::fill(table.begin(), table.end(), Entry{}); }
+
+const MateSolver::Entry* MateSolver::probe(U64 key, int plies) const {
+    const U64 k = depth_key(key, plies);
+    const Entry* bucket = &table[k & mask];
+    for (int i = 0; i < BUCKET_SIZE; ++i)
+        if (bucket[i].work != 0 && bucket[i].key == k) return &bucket[i];
+    return nullptr;
+}
+
+// Replaces the same position or else the entry with the least work behind it.
+void MateSolver::store(U64 key, int plies, uint32_t pn, uint32_t dn, uint64_t work) {
+    const U64 k = depth_key(key, plies);
+    Entry* bucket = &table[k & mask];
+    Entry* victim = &bucket[0];
+    for (int i = 0; i < BUCKET_SIZE; ++i) {
+        if (bucket[i].work != 0 && bucket[i].key == k) {
+            victim = &bucket[i];
+            break;
+        }
+        if (bucket[i].work < victim->work) victim = &bucket[i];
+    }
+    *victim = Entry{k, pn, dn, static_cast<uint32_t>(std::clamp<uint64_t>(work, 1, UINT32_MAX))};
+}
+
+// Legal moves; with one ply left the attacker only needs its checks.
+void MateSolver::generate(board::Position& pos, int plies, bool orNode, movegen::MoveList& moves) const {
+    pos.generate_legal(moves);
+    if (!orNode || plies != 1) return;
+    std::size_t kept = 0;
+    board::StateInfo st;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const movegen::Move m = moves.moves[i];
+        pos.make_move(m, st);
+        const bool check = pos.in_check();
+        pos.unmake_move(m, st);
+        if (check) moves.moves[kept++] = m;
+    }
+    moves.count = kept;
+}
+
+void MateSolver::check_limits() {
+    if (limits.nodes && nodes >= limits.nodes) stopped = true;
+    if ((nodes & (TIME_CHECK_INTERVAL - 1)) != 0) return;
+    if (limits.stop && limits.stop->load(std::memory_order_relaxed)) stopped = true;
+    const bool pondering = limits.ponder && limits.ponder->load(std::memory_order_relaxed);
+    if (!pondering && timer.hard_limit_reached()) stopped = true;
+}
+
+// Multiple iterative deepening: searches below this node until its proof
+// number reaches thPn or its disproof number reaches thDn, and returns both.
+void MateSolver::mid(board::Position& pos, int plies, bool orNode, uint32_t thPn, uint32_t thDn, uint32_t& pn,
+                     uint32_t& dn) {
+    ++nodes;
+    check_limits();
+    const uint64_t startNodes = nodes;
+
+    movegen::MoveList moves;
+    generate(pos, plies, orNode, moves);
+    // Leaves: the attacker has no (checking) move, or the defender has no
+    // plies left. The defender is only lost if mated right here.
+    if (moves.size() == 0 || plies == 0) {
+        const bool mated = !orNode && moves.size() == 0 && pos.in_check();
+        pn = mated ? 0 : PN_INFINITE;
+        dn = mated ? PN_INFINITE : 0;
+        store(pos.key(), plies, pn, dn, 1);
+        return;
+    }
+
+    // Children start from their stored numbers, or 1/1 if never seen. They
+    // are tracked locally so an evicted child cannot make the loop spin.
+    const std::size_t count = moves.size();
+    uint32_t childPn[movegen::MAX_MOVES];
+    uint32_t childDn[movegen::MAX_MOVES];
+    for (std::size_t i = 0; i < count; ++i) {
+        const Entry* e = probe(pos.key_after(moves.moves[i]), plies - 1);
+        childPn[i] = e ? e->pn : 1;
+        childDn[i] = e ? e->dn : 1;
+    }
+
+    // At an OR node pn is the children's minimum pn and dn the sum of their
+    // dn; an AND node is the mirror image.
+    uint32_t* minOf = orNode ? childPn : childDn;
+    uint32_t* sumOf = orNode ? childDn : childPn;
+    board::StateInfo st;
+    while (true) {
+        std::size_t best = 0;
+        uint32_t second = PN_INFINITE;
+        uint64_t sum = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            sum += sumOf[i];
+            if (i == 0) continue;
+            if (minOf[i] < minOf[best]) {
+                second = minOf[best];
+                best = i;
+            } else if (minOf[i] < second) {
+                second = minOf[i];
+            }
+        }
+        const uint32_t minValue = minOf[best];
+        const uint32_t sumValue = static_cast<uint32_t>(std::min<uint64_t>(sum, PN_INFINITE));
+        pn = orNode ? minValue : sumValue;
+        dn = orNode ? sumValue : minValue;
+        if (pn >= thPn || dn >= thDn || stopped) break;
+
+        // The chosen child may work until it stops being the most proving
+        // one (passes the runner-up by a quarter, the 1+epsilon trick that
+        // curbs switching between siblings) or the parent's other threshold
+        // is hit.
+        const uint32_t thMin = orNode ? thPn : thDn;
+        const uint32_t thSum = orNode ? thDn : thPn;
+        const uint32_t childThMin = static_cast<uint32_t>(std::min<uint64_t>(thMin, uint64_t{second} + second / 4 + 1));
+        const uint32_t childThSum = thSum - sumValue + sumOf[best];
+        const movegen::Move m = moves.moves[best];
+        pos.make_move(m, st);
+        mid(pos, plies - 1, !orNode, orNode ? childThMin : childThSum, orNode ? childThSum : childThMin, childPn[best],
+            childDn[best]);
+        pos.unmake_move(m, st);
+    }
+    store(pos.key(), plies, pn, dn, nodes - startNodes + 1);
+}
+
+bool MateSolver::prove(board::Position& pos, int plies, bool orNode) {
+    uint32_t pn = 0, dn = 0;
+    mid(pos, plies, orNode, PN_INFINITE, PN_INFINITE, pn, dn);
+    return pn == 0;
+}
+
+// Next move of the mating line from a node that mates in exactly `plies`.
+// The attacker needs a child proven within one ply less; the defender a
+// reply that is not proven two plies sooner, and one such reply exists or
+// the node would have been proven two plies sooner itself. Children the
+// hash has already decided are preferred; the rest are searched.
+movegen::Move MateSolver::pv_move(board::Position& pos, int plies) {
+    const bool orNode = plies % 2 == 1;
+    movegen::MoveList moves;
+    pos.generate_legal(moves);
+    if (!orNode && plies < 3) return moves.size() ? moves.moves[0] : 0;
+
+    const int childPlies = orNode ? plies - 1 : plies - 3;
+    // Defender replies whose proofs took the most work are the likeliest to
+    // hold out longest, so they are tried first.
+    std::vector<std::pair<uint32_t, movegen::Move>> order;
+    for (const movegen::Move m : moves) {
+        const Entry* e = orNode ? nullptr : probe(pos.key_after(m), plies - 1);
+        order.emplace_back(e ? e->work : 0, m);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (const auto& [work, m] : order) {
+        const Entry* e = probe(pos.key_after(m), childPlies);
+        if (e && (orNode ? e->pn == 0 : e->dn == 0)) return m;
+    }
+    board::StateInfo st;
+    for (const auto& [work, m] : order) {
+        const Entry* e = probe(pos.key_after(m), childPlies);
+        if (e && (e->pn == 0 || e->dn == 0)) continue;
+        pos.make_move(m, st);
+        const bool childProven = prove(pos, childPlies, !orNode);
+        pos.unmake_move(m, st);
+        if (childProven == orNode) return m;
+        if (stopped) break;
+    }
+    return 0;
+}
+
+MateResult MateSolver::solve(board::Position& pos, int maxMoves, const Limits& searchLimits, int moveOverheadMs) {
+    limits = searchLimits;
+    timer.start(limits, moveOverheadMs);
+    nodes = 0;
+    stopped = false;
+
+    MateResult result;
+    maxMoves = std::min(maxMoves, MAX_PLY / 2);
+    for (int n = 1; n <= maxMoves && !stopped; ++n) {
+        if (prove(pos, 2 * n - 1, true)) {
+            result.mateIn = n;
+            break;
+        }
+    }
+    result.complete = !stopped;
+
+    if (result.mateIn) {
+        board::StateInfo states[MAX_PLY];
+        // The first move comes straight from the proof, even after a stop.
+        for (int plies = 2 * result.mateIn - 1; plies > 0 && (result.pv.empty() || !stopped); --plies) {
+            const movegen::Move m = pv_move(pos, plies);
+            if (!m) break;
+            pos.make_move(m, states[result.pv.size()]);
+            result.pv.push_back(m);
+        }
+        for (std::size_t i = result.pv.size(); i-- > 0;) pos.unmake_move(result.pv[i], states[i]);
+    }
+
+    result.nodes = nodes;
+    result.timeMs = timer.elapsed_ms();
+    return result;
+}
+
+} // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "engine/util/types.h"
+#include "engine/movegen/move.h"
+#include "engine/board/position.h"
+#include "engine/search/search.h"
+#include "engine/search/timeman.h"
+
+namespace phish::search {
+
+struct MateResult {
+    int mateIn = 0;        // moves, 0 when no mate was proven
+    bool complete = false; // every length up to the limit was decided; with mateIn == 0, no mate exists
+    std::vector<movegen::Move> pv;
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+};
+
+// Depth-first proof-number search (df-pn) for forced mates.
+//
+// Nodes where the attacker moves are OR nodes (one mating move suffices),
+// defender nodes are AND nodes (every reply must lose). Each node carries a
+// proof number (how many leaves still have to be proven to prove it) and a
+// disproof number; the search always expands the most-proving leaf and
+// only backs up to the parent once a threshold derived from the siblings
+// is crossed. Proofs depend on the plies left, so the hash keys on both the
+// position and the remaining depth; with the depth strictly decreasing the
+// searched graph is acyclic.
+class MateSolver {
+public:
+    explicit MateSolver(std::size_t hashMb);
+
+    MateSolver(const MateSolver&) = delete;
+    MateSolver& operator=(const MateSolver&) = delete;
+
+    void clear();
+
+    // Looks for the shortest mate of the side to move in up to `maxMoves`
+    // moves, trying each length in turn. Honors the node, time and stop
+    // limits in `limits`.
+    MateResult solve(board::Position& pos, int maxMoves, const Limits& limits, int moveOverheadMs = 0);
+
+private:
+    struct Entry {
+        U64 key = 0;
+        uint32_t pn = 0;
+        uint32_t dn = 0;
+        uint32_t work = 0; // nodes spent under this entry, for replacement; 0 marks an empty slot
+    };
+
+    static constexpr int BUCKET_SIZE = 4;
+
+    const Entry* probe(U64 key, int plies) const;
+    void store(U64 key, int plies, uint32_t pn, uint32_t dn, uint64_t work);
+    void generate(board::Position& pos, int plies, bool orNode, movegen::MoveList& moves) const;
+    void mid(board::Position& pos, int plies, bool orNode, uint32_t thPn, uint32_t thDn, uint32_t& pn, uint32_t& dn);
+    bool prove(board::Position& pos, int plies, bool orNode);
+    movegen::Move pv_move(board::Position& pos, int plies);
+    void check_limits();
+
+    std::vector<Entry> table;
+    std::size_t mask = 0;
+    Limits limits;
+    TimeManager timer;
+    uint64_t nodes = 0;
+    bool stopped = false;
+};
+
+} // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "engine/search/params.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iterator>
+
+namespace phish::search {
+
+static SearchParams g_params;
+
+static const ParamSpec PARAM_SPECS[] = {
+    {"LMRBase", &SearchParams::lmrBase, 0, 300},
+    {"LMRDivisor", &SearchParams::lmrDivisor, 100, 500},
+    {"LMPBase", &SearchParams::lmpBase, 1, 20},
+    {"LMPMaxDepth", &SearchParams::lmpMaxDepth, 0, 16},
+    {"FutilityBase", &SearchParams::futilityBase, 0, 500},
+    {"FutilityMargin", &SearchParams::futilityMargin, 0, 500},
+    {"FutilityMaxDepth", &SearchParams::futilityMaxDepth, 0, 16},
+    {"RFPMargin", &SearchParams::rfpMargin, 0, 500},
+    {"RFPMaxDepth", &SearchParams::rfpMaxDepth, 0, 16},
+    {"RazorMargin", &SearchParams::razorMargin, 0, 1000},
+    {"RazorMaxDepth", &SearchParams::razorMaxDepth, 0, 8},
+    {"NMPBase", &SearchParams::nmpBase, 1, 8},
+    {"NMPDepthDiv", &SearchParams::nmpDepthDiv, 1, 16},
+    {"NMPEvalDiv", &SearchParams::nmpEvalDiv, 50, 1000},
+    {"AspirationWindow", &SearchParams::aspirationWindow, 0, 500},
+    {"IIRMinDepth", &SearchParams::iirMinDepth, 0, 16},
+    {"IIDMinDepth", &SearchParams::iidMinDepth, 0, 16},
+    {"IIDReduction", &SearchParams::iidReduction, 1, 8},
+};
+
+SearchParams& params() { return g_params; }
+
+const ParamSpec* param_specs(std::size_t& count) {
+    count = std::size(PARAM_SPECS);
+    return PARAM_SPECS;
+}
+
+static bool iequals(const std::string& a, const char* b) {
+    std::size_t i = 0;
+    for (; i < a.size() && b[i]; ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) return false;
+    }
+    return i == a.size() && b[i] == '\0';
+}
+
+bool set_param(const std::string& name, const std::string& value) {
+    for (const ParamSpec& spec : PARAM_SPECS) {
+        if (!iequals(name, spec.name)) continue;
+        const long v = std::strtol(value.c_str(), nullptr, 10);
+        g_params.*spec.field = static_cast<int>(std::clamp<long>(v, spec.min, spec.max));
+        return true;
+    }
+    return false;
+}
+
+} // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace phish::search {
+
+// Tunable pruning/reduction parameters. Each one is exposed as a UCI spin
+// option so SPSA-style tuners can drive it without rebuilding.
+struct SearchParams {
+    int lmrBase = 75;            // reduction = lmrBase / 100 + ln(depth) * ln(moveCount) * 100 / lmrDivisor
+    int lmrDivisor = 225;
+    int lmpBase = 3;             // quiets searched before pruning: lmpBase + depth^2
+    int lmpMaxDepth = 8;
+    int futilityBase = 60;
+    int futilityMargin = 90;     // per ply of depth
+    int futilityMaxDepth = 6;
+    int rfpMargin = 80;          // reverse futility, per ply of depth
+    int rfpMaxDepth = 7;
+    int razorMargin = 250;       // per ply of depth
+    int razorMaxDepth = 2;
+    int nmpBase = 3;             // R = nmpBase + depth / nmpDepthDiv + min((eval - beta) / nmpEvalDiv, 3)
+    int nmpDepthDiv = 4;
+    int nmpEvalDiv = 200;
+    int aspirationWindow = 25;   // initial half-width in cp, 0 searches every iteration with a full window
+    int iirMinDepth = 4;         // nodes without a TT move lose one ply from this depth on, 0 = off
+    int iidMinDepth = 0;         // PV nodes without a TT move first search depth - iidReduction, 0 = off
+    int iidReduction = 2;
+};
+
+struct ParamSpec {
+    const char* name;
+    int SearchParams::*field;
+    int min;
+    int max;
+};
+
+SearchParams& params();
+
+const ParamSpec* param_specs(std::size_t& count);
+
+// Sets a parameter by UCI option name (case-insensitive). Returns false if
+// `name` is not a search parameter.
+bool set_param(const std::string& name, const std::string& value);
+
+} // namespace phish::search
\ No newline at end of file
@@ -1,8 +1,20 @@
 #include "engine/search/search.h"
 
 #include <algorithm>
-#include <cstring>
+#include <cmath>
+#include <cstdlib>
 #include <limits>
+#include <vector>
+
+#include "engine/bitbase/bitbase.h"
+#include "engine/eval/evaluate.h"
+#include "engine/eval/material.h"
+#include "engine/eval/pawns.h"
+#include "engine/search/evalcache.h"
+#include "engine/search/history.h"
+#include "engine/search/mate.h"
+#include "engine/search/params.h"
+#include "engine/search/timeman.h"
 
 namespace phish::search {
 
@@ -17,165 +29,868 @@ static int piece_value(PieceType pt) {
     }
 }
 
-static inline int popcount64(U64 v) { return __builtin_popcountll(v); }
+static constexpr uint64_t TIME_CHECK_INTERVAL = 1024;
 
-static int evaluate(const board::Position& pos) {
-    int score = 0;
-    for (int c = 0; c < COLOR_NB; ++c) {
-        int sign = (c == WHITE) ? 1 : -1;
-        for (int pt = PAWN; pt <= QUEEN; ++pt) {
-            Piece piece = static_cast<Piece>(c * 6 + pt);
-            U64 bb = pos.pieces(piece);
-            score += sign * popcount64(bb) * piece_value(static_cast<PieceType>(pt));
-        }
+static constexpr std::size_t MATE_HASH_MB = 16;
+
+// Mate and bitbase scores are stored relative to the node, not the root, so
+// a TT hit at a different ply still reports the right distance.
+static int score_to_tt(int score, int ply) {
+    if (score >= VALUE_TB_WIN_IN_MAX_PLY) return score + ply;
+    if (score <= -VALUE_TB_WIN_IN_MAX_PLY) return score - ply;
+    return score;
+}
+
+static int score_from_tt(int score, int ply) {
+    if (score >= VALUE_TB_WIN_IN_MAX_PLY) return score - ply;
+    if (score <= -VALUE_TB_WIN_IN_MAX_PLY) return score + ply;
+    return score;
+}
+
+// Value of the piece captured by m (pawn for en passant), 0 for quiet moves.
+static int captured_value(const board::Position& pos, movegen::Move m) {
+    if (movegen::is_enpassant(m)) return piece_value(PAWN);
+    const int pc = pos.piece_at(movegen::to_sq(m));
+    return pc == NO_PIECE ? 0 : piece_value(static_cast<PieceType>(pc % 6));
+}
+
+// MVV-LVA: most valuable victim first, least valuable attacker breaks ties.
+static int mvv_lva(const board::Position& pos, movegen::Move m) {
+    const int attacker = pos.piece_at(movegen::from_sq(m)) % 6;
+    int score = captured_value(pos, m) * 8 - attacker;
+    if (movegen::is_promotion(m)) score += piece_value(movegen::promotion_piece(m)) * 8;
+    return score;
+}
+
+// Captured piece type for history indexing; NO_PIECE_TYPE for quiet promotions.
+static int captured_type(const board::Position& pos, movegen::Move m) {
+    if (movegen::is_enpassant(m)) return PAWN;
+    const int pc = pos.piece_at(movegen::to_sq(m));
+    return pc == NO_PIECE ? NO_PIECE_TYPE : pc % 6;
+}
+
+static bool is_quiet(movegen::Move m) { return !movegen::is_capture(m) && !movegen::is_promotion(m); }
+
+// Swap the best remaining move into slot i (selection sort step).
+static void pick_next(movegen::MoveList& list, std::size_t i) {
+    std::size_t best = i;
+    for (std::size_t j = i + 1; j < list.size(); ++j)
+        if (list.scores[j] > list.scores[best]) best = j;
+    std::swap(list.moves[i], list.moves[best]);
+    std::swap(list.scores[i], list.scores[best]);
+}
+
+static constexpr int SCORE_TT_MOVE = 1 << 30;
+static constexpr int SCORE_GOOD_CAPTURE = 1 << 28;
+static constexpr int SCORE_KILLER_1 = (1 << 27) + 2;
+static constexpr int SCORE_KILLER_2 = (1 << 27) + 1;
+static constexpr int SCORE_COUNTER = 1 << 27;
+static constexpr int SCORE_BAD_CAPTURE = -(1 << 28);
+
+static constexpr int DELTA_MARGIN = 200;
+
+static bool has_non_pawn_material(const board::Position& pos, Color c) {
+    const int base = c * 6;
+    return (pos.pieces(static_cast<Piece>(base + KNIGHT)) | pos.pieces(static_cast<Piece>(base + BISHOP)) |
+            pos.pieces(static_cast<Piece>(base + ROOK)) | pos.pieces(static_cast<Piece>(base + QUEEN))) != 0;
+}
+
+// currmove lines are only worth their output volume on long searches.
+static constexpr int64_t CURRMOVE_DELAY_MS = 3000;
+
+struct StackEntry {
+    int piece = NO_PIECE;  // piece that moved into this ply, NO_PIECE after a null move
+    Square to = SQ_NONE;
+};
+
+// A legal root move with its score from the current and the previous
+// iteration. The list persists across iterations and is re-sorted after
+// each one, so the best move never has to be recovered from the TT. `pv`
+// is the line last found for this move, starting with the move itself.
+struct RootMove {
+    movegen::Move move = 0;
+    int score = -VALUE_INFINITE;
+    int previousScore = -VALUE_INFINITE;
+    movegen::Move pv[MAX_PLY + 1] = {};
+    int pvLength = 0;
+};
+
+// All state of one search. Killers are reset for every search; the history
+// tables persist until clear(). The whole object is heap-allocated, so its
+// tables (about 2.8 MB) never sit on a thread's stack.
+struct SearchContext::Worker {
+    explicit Worker(TranspositionTable& table) : tt(table) {}
+
+    TranspositionTable& tt;
+
+    uint64_t nodes = 0;
+    uint64_t qnodes = 0;
+    uint64_t evalCalls = 0;
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    uint64_t failHigh = 0;
+    uint64_t failHighFirst = 0;
+    uint64_t tbHits = 0;
+    int selDepth = 0;
+
+    // Men of the largest loaded bitbase, 0 for none, and the root's material:
+    // nodes with the root's material are searched, not probed, so the search
+    // still makes progress in a won ending instead of shuffling between
+    // equally won positions.
+    int tbMen = 0;
+    U64 rootMaterial = 0;
+
+    // Limits of the running search. `stopped` is raised by the node/time
+    // checks or an external stop request and unwinds the search; results of
+    // the interrupted iteration are dropped.
+    Limits limits;
+    TimeManager timer;
+    bool stopped = false;
+    bool pondering = false;
+
+    Heuristics heur{};
+    EvalCache evalCache{};
+    eval::EvalState evalState;
+    StackEntry stack[MAX_PLY + 1];
+
+    // Triangular PV table: pvTable[ply] holds the best line found so far
+    // from `ply`, pvLength[ply] its length. Nodes reset their own line on
+    // entry; an improvement inside the window prepends the move to the
+    // child's line.
+    movegen::Move pvTable[MAX_PLY + 2][MAX_PLY + 2] = {};
+    int pvLength[MAX_PLY + 2] = {};
+
+    // Late-move reductions in plies, indexed by [depth][moveCount].
+    int reductions[64][64] = {};
+
+    // Created on the first `go mate`.
+    std::unique_ptr<MateSolver> mateSolver;
+
+    void poll_ponder();
+    void check_limits();
+    bool make_move(board::Position& pos, movegen::Move m, board::StateInfo& st);
+    void unmake_move(board::Position& pos, movegen::Move m, const board::StateInfo& st);
+    int static_eval(const board::Position& pos, const TTEntry* tte);
+    void update_pv(int ply, movegen::Move m);
+    int16_t (*continuation_row(int ply, int back))[64];
+    void score_moves(const board::Position& pos, movegen::MoveList& list, movegen::Move ttMove, int ply);
+    void update_heuristics(const board::Position& pos, movegen::Move best, int depth, int ply,
+                           const movegen::Move* quiets, int quietCount,
+                           const movegen::Move* captures, int captureCount);
+    int qsearch(board::Position& pos, int alpha, int beta, int ply);
+    int negamax(board::Position& pos, int depth, int alpha, int beta, int ply);
+    void filter_root_moves(board::Position& pos, std::vector<RootMove>& rootMoves);
+    void init_reductions();
+    void report(const RootMove& line, int multiPv, int depth, int score, int alpha, int beta);
+    int root_search(board::Position& pos, std::vector<RootMove>& rootMoves, std::size_t first, int depth, int alpha,
+                    int beta);
+    SearchResult think(board::Position& pos, const Limits& searchLimits, int moveOverheadMs);
+    SearchResult solve_mate(board::Position& pos, const Limits& searchLimits, int moveOverheadMs);
+};
+
+// On ponderhit the search keeps its tree and TT and continues as a timed
+// search whose clock starts now.
+void SearchContext::Worker::poll_ponder() {
+    if (pondering && !limits.ponder->load(std::memory_order_relaxed)) {
+        pondering = false;
+        timer.restart();
     }
-    return (pos.side_to_move() == WHITE) ? score : -score;
 }
 
-TranspositionTable::TranspositionTable(std::size_t mb) { resize(mb); }
-TranspositionTable::~TranspositionTable() { delete[] table; }
+void SearchContext::Worker::check_limits() {
+    if (limits.nodes && nodes >= limits.nodes) stopped = true;
+    if ((nodes & (TIME_CHECK_INTERVAL - 1)) != 0) return;
+    if (limits.stop && limits.stop->load(std::memory_order_relaxed)) stopped = true;
+    poll_ponder();
+    if (!pondering && timer.hard_limit_reached()) stopped = true;
+}
+
+// Moves inside the tree go through these so the network's accumulators
+// follow the position.
+bool SearchContext::Worker::make_move(board::Position& pos, movegen::Move m, board::StateInfo& st) {
+    if (!pos.make_move(m, st)) return false;
+    evalState.accumulators.push(st.dirty);
+    return true;
+}
+
+void SearchContext::Worker::unmake_move(board::Position& pos, movegen::Move m, const board::StateInfo& st) {
+    evalState.accumulators.pop();
+    pos.unmake_move(m, st);
+}
+
+// Static eval of a node not in check: from its TT entry when that has one,
+// else from the eval cache, computing it only when both miss.
+int SearchContext::Worker::static_eval(const board::Position& pos, const TTEntry* tte) {
+    if (tte && tte->eval != VALUE_NONE) return tte->eval;
+    int eval;
+    if (evalCache.probe(pos.key(), eval)) return eval;
+    ++evalCalls;
+    eval = eval::evaluate(pos, evalState);
+    evalCache.store(pos.key(), eval);
+    return eval;
+}
 
-void TranspositionTable::resize(std::size_t mb) {
-    delete[] table;
-    std::size_t bytes = mb * 1024ULL * 1024ULL;
-    numEntries = bytes / sizeof(TTEntry);
-    if (numEntries == 0) numEntries = 1;
-    table = new TTEntry[numEntries];
-    clear();
+void SearchContext::Worker::update_pv(int ply, movegen::Move m) {
+    pvTable[ply][0] = m;
+    std::copy(pvTable[ply + 1], pvTable[ply + 1] + pvLength[ply + 1], pvTable[ply] + 1);
+    pvLength[ply] = pvLength[ply + 1] + 1;
 }
 
-void TranspositionTable::clear() {
-    if (!table) return;
-    std::memset(table, 0, numEntries * sizeof(TTEntry));
-    ++currentAge;
+// Continuation-history rows for the moves one and two plies back, or
+// nullptr when there is no such move (root, null move).
+int16_t (*SearchContext::Worker::continuation_row(int ply, int back))[64] {
+    if (ply < back) return nullptr;
+    const StackEntry& e = stack[ply - back];
+    if (e.piece == NO_PIECE) return nullptr;
+    return heur.continuation[e.piece][e.to];
 }
 
-void TranspositionTable::store(U64 key, int depth, int score, int eval, uint8_t flag, movegen::Move move) {
-    if (!table) return;
-    std::size_t idx = key % numEntries;
-    TTEntry& e = table[idx];
-    if (e.key != key || depth >= e.depth) {
-        e.key = key;
-        e.depth = static_cast<uint16_t>(depth);
-        e.score = static_cast<int16_t>(score);
-        e.eval = static_cast<int16_t>(eval);
-        e.flag = flag;
-        e.move = move;
-        e.age = currentAge;
+// Score every move once: TT move, SEE-winning captures (MVV + capture
+// history), killers, countermove, quiets by butterfly + continuation
+// history, then losing captures.
+void SearchContext::Worker::score_moves(const board::Position& pos, movegen::MoveList& list, movegen::Move ttMove,
+                                        int ply) {
+    const Color us = pos.side_to_move();
+    const movegen::Move* killers = heur.killers[ply];
+    const StackEntry& prev = stack[ply > 0 ? ply - 1 : 0];
+    const movegen::Move counter = (ply > 0 && prev.piece != NO_PIECE) ? heur.counterMoves[prev.piece][prev.to] : 0;
+    auto* cont1 = continuation_row(ply, 1);
+    auto* cont2 = continuation_row(ply, 2);
+
+    for (std::size_t i = 0; i < list.size(); ++i) {
+        const movegen::Move m = list.moves[i];
+        const Square from = movegen::from_sq(m);
+        const Square to = movegen::to_sq(m);
+        const int pc = pos.piece_at(from);
+        int score;
+        if (m == ttMove) {
+            score = SCORE_TT_MOVE;
+        } else if (!is_quiet(m)) {
+            score = mvv_lva(pos, m) * 16 + heur.captureHistory[pc][to][captured_type(pos, m)];
+            score += pos.see_ge(m, 0) ? SCORE_GOOD_CAPTURE : SCORE_BAD_CAPTURE;
+        } else if (m == killers[0]) {
+            score = SCORE_KILLER_1;
+        } else if (m == killers[1]) {
+            score = SCORE_KILLER_2;
+        } else if (m == counter) {
+            score = SCORE_COUNTER;
+        } else {
+            score = heur.butterfly[us][from][to];
+            if (cont1) score += cont1[pc][to];
+            if (cont2) score += cont2[pc][to];
+        }
+        list.scores[i] = score;
     }
 }
 
-bool TranspositionTable::probe(U64 key, TTEntry& out) const {
-    if (!table) return false;
-    std::size_t idx = key % numEntries;
-    const TTEntry& e = table[idx];
-    if (e.key == key) { out = e; return true; }
-    return false;
+// Reward the move that caused a beta cutoff and penalise the moves of the
+// same kind that were searched before it.
+void SearchContext::Worker::update_heuristics(const board::Position& pos, movegen::Move best, int depth, int ply,
+                                                const movegen::Move* quiets, int quietCount,
+                                                const movegen::Move* captures, int captureCount) {
+    const Color us = pos.side_to_move();
+    const int bonus = history_bonus(depth);
+
+    auto capture_entry = [&](movegen::Move m) -> int16_t& {
+        return heur.captureHistory[pos.piece_at(movegen::from_sq(m))][movegen::to_sq(m)][captured_type(pos, m)];
+    };
+
+    if (is_quiet(best)) {
+        movegen::Move* killers = heur.killers[ply];
+        if (killers[0] != best) {
+            killers[1] = killers[0];
+            killers[0] = best;
+        }
+        if (ply > 0 && stack[ply - 1].piece != NO_PIECE)
+            heur.counterMoves[stack[ply - 1].piece][stack[ply - 1].to] = best;
+
+        auto* cont1 = continuation_row(ply, 1);
+        auto* cont2 = continuation_row(ply, 2);
+        auto update_quiet = [&](movegen::Move m, int b) {
+            const Square from = movegen::from_sq(m);
+            const Square to = movegen::to_sq(m);
+            const int pc = pos.piece_at(from);
+            update_history(heur.butterfly[us][from][to], b);
+            if (cont1) update_history(cont1[pc][to], b);
+            if (cont2) update_history(cont2[pc][to], b);
+        };
+        update_quiet(best, bonus);
+        for (int i = 0; i < quietCount; ++i) update_quiet(quiets[i], -bonus);
+    } else {
+        update_history(capture_entry(best), bonus);
+    }
+    for (int i = 0; i < captureCount; ++i) update_history(capture_entry(captures[i]), -bonus);
 }
 
-static uint64_t g_nodes;
+int SearchContext::Worker::qsearch(board::Position& pos, int alpha, int beta, int ply) {
+    ++nodes;
+    ++qnodes;
+    check_limits();
+    pvLength[ply] = 0;
+    if (stopped) return 0;
+    selDepth = std::max(selDepth, ply);
+
+    const bool pvNode = beta - alpha > 1;
+    const bool inCheck = pos.in_check();
+    if (ply >= MAX_PLY) return inCheck ? 0 : eval::evaluate(pos, evalState);
+
+    TTEntry tte{};
+    movegen::Move ttMove = 0;
+    ++ttProbes;
+    const bool ttHit = tt.probe(pos.key(), tte);
+    if (ttHit) {
+        ++ttHits;
+        // As in negamax, PV nodes search on so the PV table stays complete.
+        if (!pvNode) {
+            const int ttScore = score_from_tt(tte.score, ply);
+            if (tte.flag == 0) return ttScore;
+            if (tte.flag == 1 && ttScore <= alpha) return ttScore;
+            if (tte.flag == 2 && ttScore >= beta) return ttScore;
+        }
+        ttMove = tte.move;
+    }
 
-static int qsearch(board::Position& pos, int alpha, int beta) {
-    ++g_nodes;
-    int stand = evaluate(pos);
-    if (stand >= beta) return beta;
-    if (stand > alpha) alpha = stand;
-    return alpha;
+    // In check there is no stand-pat: every evasion is searched and having
+    // none means mate.
+    int standPat = VALUE_NONE;
+    int bestScore = -VALUE_MATE + ply;
+    if (!inCheck) {
+        standPat = static_eval(pos, ttHit ? &tte : nullptr);
+        if (standPat >= beta) {
+            tt.store(pos.key(), 0, score_to_tt(standPat, ply), standPat, 2, 0);
+            return standPat;
+        }
+        if (standPat > alpha) alpha = standPat;
+        bestScore = standPat;
+    }
+
+    movegen::MoveList moves;
+    if (inCheck) pos.generate_legal(moves);
+    else pos.generate_captures(moves);
+
+    for (std::size_t i = 0; i < moves.size(); ++i)
+        moves.scores[i] = moves.moves[i] == ttMove ? SCORE_TT_MOVE : mvv_lva(pos, moves.moves[i]);
+
+    const int alphaOrig = alpha;
+    movegen::Move bestMove = 0;
+    board::StateInfo st;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        pick_next(moves, i);
+        const movegen::Move m = moves.moves[i];
+
+        if (!inCheck && !movegen::is_promotion(m)) {
+            // Delta pruning: even winning the victim for free cannot reach alpha.
+            if (standPat + captured_value(pos, m) + DELTA_MARGIN <= alpha) continue;
+            // SEE pruning: skip captures that lose material.
+            if (!pos.see_ge(m, 0)) continue;
+        }
+
+        tt.prefetch(pos.key_after(m));
+        if (!make_move(pos, m, st)) continue;
+        const int score = -qsearch(pos, -beta, -alpha, ply + 1);
+        unmake_move(pos, m, st);
+        if (stopped) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = m;
+            if (score > alpha) {
+                alpha = score;
+                if (score < beta) update_pv(ply, m);
+            }
+            if (alpha >= beta) break;
+        }
+    }
+
+    uint8_t flag = 0;
+    if (bestScore <= alphaOrig) flag = 1;
+    else if (bestScore >= beta) flag = 2;
+    tt.store(pos.key(), 0, score_to_tt(bestScore, ply), standPat, flag, bestMove);
+    return bestScore;
 }
 
-static int score_move(movegen::Move m, movegen::Move ttMove) {
-    if (m == ttMove) return 1000000;
-    // Captures are better
-    return movegen::is_capture(m) ? 10000 : 0;
+void SearchContext::Worker::init_reductions() {
+    const SearchParams& p = params();
+    for (int d = 1; d < 64; ++d)
+        for (int m = 1; m < 64; ++m)
+            reductions[d][m] = static_cast<int>(p.lmrBase / 100.0 + std::log(d) * std::log(m) * 100.0 / p.lmrDivisor);
 }
 
-static int negamax(board::Position& pos, int depth, int alpha, int beta, TranspositionTable& tt) {
-    if (depth == 0) return qsearch(pos, alpha, beta);
+int SearchContext::Worker::negamax(board::Position& pos, int depth, int alpha, int beta, int ply) {
+    if (depth <= 0) return qsearch(pos, alpha, beta, ply);
+    pvLength[ply] = 0;
+    if (stopped) return 0;
+    if (ply >= MAX_PLY) return eval::evaluate(pos, evalState);
+    selDepth = std::max(selDepth, ply);
+
+    const SearchParams& prm = params();
+    const bool pvNode = beta - alpha > 1;
+    const bool inCheck = pos.in_check();
 
     TTEntry tte{};
     movegen::Move ttMove = 0;
-    if (tt.probe(pos.key(), tte) && tte.depth >= depth) {
-        if (tte.flag == 0) return tte.score;
-        if (tte.flag == 1 && tte.score <= alpha) return alpha;
-        if (tte.flag == 2 && tte.score >= beta) return beta;
+    ++ttProbes;
+    const bool ttHit = tt.probe(pos.key(), tte);
+    if (ttHit) {
+        ++ttHits;
+        if (!pvNode && tte.depth >= depth) {
+            const int ttScore = score_from_tt(tte.score, ply);
+            if (tte.flag == 0) return ttScore;
+            if (tte.flag == 1 && ttScore <= alpha) return alpha;
+            if (tte.flag == 2 && ttScore >= beta) return beta;
+        }
         ttMove = tte.move;
     }
 
-    // Null-move pruning
-    if (depth >= 3 && !pos.in_check()) {
-        board::StateInfo st;
-        if (pos.make_null_move(st)) {
-            int R = 2;
-            int score = -negamax(pos, depth - 1 - R, -beta, -beta + 1, tt);
-            pos.unmake_null_move(st);
-            if (score >= beta) return beta;
+    bitbase::Wdl wdl;
+    if (tbMen && pos.material_key() != rootMaterial && bitbase::probe(pos, wdl)) {
+        ++tbHits;
+        // A win is a lower bound: a mate found by searching on beats it.
+        const int score = wdl == bitbase::Wdl::Win    ? VALUE_TB_WIN - ply
+                          : wdl == bitbase::Wdl::Loss ? -VALUE_TB_WIN + ply
+                                                      : 0;
+        const uint8_t flag = wdl == bitbase::Wdl::Win ? 2 : wdl == bitbase::Wdl::Loss ? 1 : 0;
+        if (flag == 0 || (flag == 2 && score >= beta) || (flag == 1 && score <= alpha)) {
+            tt.store(pos.key(), std::min(depth + 6, MAX_PLY - 1), score_to_tt(score, ply), VALUE_NONE, flag, 0);
+            return score;
+        }
+    }
+
+    const int staticEval = inCheck ? -VALUE_INFINITE : static_eval(pos, ttHit ? &tte : nullptr);
+
+    if (!pvNode && !inCheck) {
+        // Reverse futility: the static eval beats beta by a depth-scaled margin.
+        if (depth <= prm.rfpMaxDepth && staticEval - prm.rfpMargin * depth >= beta && std::abs(beta) < VALUE_MATE_IN_MAX_PLY)
+            return staticEval;
+
+        // Razoring: hopeless on static eval, verify with qsearch and give up.
+        if (depth <= prm.razorMaxDepth && staticEval + prm.razorMargin * depth < alpha) {
+            const int score = qsearch(pos, alpha, alpha + 1, ply);
+            if (score <= alpha) return score;
         }
+
+        // Null-move pruning with a depth- and eval-adaptive reduction; skipped
+        // without non-pawn material where zugzwang is likely.
+        if (depth >= 3 && staticEval >= beta && has_non_pawn_material(pos, pos.side_to_move())) {
+            board::StateInfo st;
+            tt.prefetch(pos.key_after_null());
+            if (pos.make_null_move(st)) {
+                evalState.accumulators.push(st.dirty);
+                const int R = prm.nmpBase + depth / prm.nmpDepthDiv + std::min((staticEval - beta) / prm.nmpEvalDiv, 3);
+                stack[ply] = StackEntry{};
+                int score = -negamax(pos, depth - 1 - R, -beta, -beta + 1, ply + 1);
+                evalState.accumulators.pop();
+                pos.unmake_null_move(st);
+                if (stopped) return 0;
+                if (score >= beta) return score >= VALUE_MATE_IN_MAX_PLY ? beta : score;
+            }
+        }
+    }
+
+    // Without a TT move the ordering is guesswork. A PV node can buy one
+    // with a reduced search of itself (IID); otherwise the node loses a ply
+    // (IIR) and the next iteration revisits it with a TT move in hand.
+    if (!ttMove && pvNode && prm.iidMinDepth > 0 && depth >= prm.iidMinDepth) {
+        negamax(pos, depth - prm.iidReduction, alpha, beta, ply);
+        if (stopped) return 0;
+        pvLength[ply] = 0;
+        if (tt.probe(pos.key(), tte)) ttMove = tte.move;
+    } else if (!ttMove && prm.iirMinDepth > 0 && depth >= prm.iirMinDepth) {
+        --depth;
     }
 
     board::StateInfo st;
     movegen::MoveList moves;
     pos.generate_legal(moves);
     if (moves.size() == 0) {
-        if (pos.in_check()) return -30000 + (100 - depth);
+        if (inCheck) return -VALUE_MATE + ply;
         return 0;
     }
 
-    // Order moves
-    std::sort(moves.moves.begin(), moves.moves.end(), [&](movegen::Move a, movegen::Move b){
-        return score_move(a, ttMove) > score_move(b, ttMove);
-    });
+    score_moves(pos, moves, ttMove, ply);
+    heur.killers[ply + 1][0] = heur.killers[ply + 1][1] = 0;
 
     int bestScore = std::numeric_limits<int>::min() / 2;
     movegen::Move bestMove = 0;
     int alphaOrig = alpha;
+    int moveCount = 0;
+    movegen::Move quietsTried[64];
+    movegen::Move capturesTried[32];
+    int quietCount = 0, captureCount = 0;
+    bool skipQuiets = false;
+    // Passed pawns of the side to move, read from the pawn hash on the first
+    // pawn push; pushing one is exempt from quiet-move pruning and LMR.
+    const int ownPawn = pos.side_to_move() * 6 + PAWN;
+    U64 passers = 0;
+    bool passersKnown = false;
+
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        pick_next(moves, i);
+        const movegen::Move m = moves.moves[i];
+        const bool quiet = is_quiet(m);
+        bool passerPush = false;
+        if (quiet && pos.piece_at(movegen::from_sq(m)) == ownPawn) {
+            if (!passersKnown) {
+                passers = evalState.pawns.probe(pos).passed[pos.side_to_move()];
+                passersKnown = true;
+            }
+            passerPush = (passers & Bit(movegen::from_sq(m))) != 0;
+        }
+
+        // Shallow-depth pruning once a non-losing score is on the board.
+        if (!pvNode && !inCheck && moveCount > 0 && bestScore > -VALUE_MATE_IN_MAX_PLY && quiet && !passerPush &&
+            m != ttMove) {
+            if (skipQuiets) continue;
+            // Late move pruning: enough quiets tried at this depth.
+            if (depth <= prm.lmpMaxDepth && quietCount >= prm.lmpBase + depth * depth) {
+                skipQuiets = true;
+                continue;
+            }
+            // Futility: even a generous positional gain cannot lift eval above alpha.
+            if (depth <= prm.futilityMaxDepth && staticEval + prm.futilityBase + prm.futilityMargin * depth <= alpha) {
+                skipQuiets = true;
+                continue;
+            }
+        }
+
+        ++nodes;
+        check_limits();
+        // Start the child's TT load now; it overlaps with make_move.
+        tt.prefetch(pos.key_after(m));
+        const int movedPiece = pos.piece_at(movegen::from_sq(m));
+        if (!make_move(pos, m, st)) continue;
+        ++moveCount;
+        stack[ply] = StackEntry{movedPiece, movegen::to_sq(m)};
+        const bool givesCheck = pos.in_check();
 
-    for (auto m : moves.moves) {
-        ++g_nodes;
-        if (!pos.make_move(m, st)) continue;
-        // PVS
         int score;
-        if (bestMove == 0) {
-            score = -negamax(pos, depth - 1, -beta, -alpha, tt);
+        if (moveCount == 1) {
+            score = -negamax(pos, depth - 1, -beta, -alpha, ply + 1);
         } else {
-            score = -negamax(pos, depth - 1, -alpha - 1, -alpha, tt);
-            if (score > alpha && score < beta) {
-                score = -negamax(pos, depth - 1, -beta, -alpha, tt);
+            // Late move reductions for quiet moves ordered after the good ones.
+            int r = 0;
+            if (depth >= 3 && quiet && !passerPush && moveCount > 1 + (pvNode ? 1 : 0)) {
+                r = reductions[std::min(depth, 63)][std::min(moveCount, 63)];
+                if (pvNode) --r;
+                if (givesCheck || inCheck) --r;
+                if (moves.scores[i] >= SCORE_COUNTER) --r;
+                r = std::clamp(r, 0, depth - 2);
             }
+            // PVS: null-window probe, re-searched at full depth/window on fail-high.
+            score = -negamax(pos, depth - 1 - r, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && r > 0)
+                score = -negamax(pos, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta)
+                score = -negamax(pos, depth - 1, -beta, -alpha, ply + 1);
         }
-        pos.unmake_move(m, st);
+        unmake_move(pos, m, st);
+        if (stopped) return 0;
         if (score > bestScore) {
             bestScore = score;
             bestMove = m;
         }
-        if (bestScore > alpha) alpha = bestScore;
-        if (alpha >= beta) break;
+        if (bestScore > alpha) {
+            alpha = bestScore;
+            if (pvNode && alpha < beta) update_pv(ply, m);
+        }
+        if (alpha >= beta) {
+            ++failHigh;
+            if (moveCount == 1) ++failHighFirst;
+            update_heuristics(pos, m, depth, ply, quietsTried, quietCount, capturesTried, captureCount);
+            break;
+        }
+        if (quiet) {
+            if (quietCount < 64) quietsTried[quietCount++] = m;
+        } else if (captureCount < 32) {
+            capturesTried[captureCount++] = m;
+        }
     }
 
     uint8_t flag = 0;
     if (bestScore <= alphaOrig) flag = 1;
     else if (bestScore >= beta) flag = 2;
-    tt.store(pos.key(), depth, bestScore, 0, flag, bestMove);
+    tt.store(pos.key(), depth, score_to_tt(bestScore, ply), inCheck ? VALUE_NONE : staticEval, flag, bestMove);
     return bestScore;
 }
 
-SearchResult think(board::Position& pos, const Limits& limits, TranspositionTable& tt) {
+void SearchContext::Worker::report(const RootMove& line, int multiPv, int depth, int score, int alpha, int beta) {
+    if (!limits.onInfo) return;
+    SearchInfo info;
+    info.multiPv = multiPv;
+    info.depth = depth;
+    info.selDepth = selDepth;
+    info.score = score;
+    info.lowerBound = score >= beta;
+    info.upperBound = score <= alpha;
+    info.nodes = nodes;
+    info.timeMs = timer.elapsed_ms();
+    info.hashfull = tt.hashfull();
+    info.tbHits = tbHits;
+    info.pv.assign(line.pv, line.pv + line.pvLength);
+    limits.onInfo(info);
+}
+
+// Root search over the persistent move list from index `first` on; the
+// moves before it are earlier MultiPV lines of this iteration. Moves after
+// the first are tried with a null window; a move that does not beat alpha
+// keeps -VALUE_INFINITE so the stable re-sort leaves it in previous order.
+int SearchContext::Worker::root_search(board::Position& pos, std::vector<RootMove>& rootMoves, std::size_t first,
+                                       int depth, int alpha, int beta) {
+    int bestScore = -VALUE_INFINITE;
+    board::StateInfo st;
+    heur.killers[1][0] = heur.killers[1][1] = 0;
+
+    for (std::size_t i = first; i < rootMoves.size(); ++i) {
+        RootMove& rm = rootMoves[i];
+        if (limits.onCurrMove && timer.elapsed_ms() >= CURRMOVE_DELAY_MS)
+            limits.onCurrMove(depth, rm.move, static_cast<int>(i) + 1);
+        ++nodes;
+        tt.prefetch(pos.key_after(rm.move));
+        const int movedPiece = pos.piece_at(movegen::from_sq(rm.move));
+        if (!make_move(pos, rm.move, st)) continue;
+        stack[0] = StackEntry{movedPiece, movegen::to_sq(rm.move)};
+
+        const int moveCount = static_cast<int>(i - first) + 1;
+        int score;
+        if (moveCount == 1) {
+            score = -negamax(pos, depth - 1, -beta, -alpha, 1);
+        } else {
+            // Same PV-node reduction rule as negamax for late quiet root moves.
+            int r = 0;
+            if (depth >= 3 && moveCount >= 3 && is_quiet(rm.move)) {
+                r = reductions[std::min(depth, 63)][std::min(moveCount, 63)] - 1;
+                if (pos.in_check()) --r;
+                r = std::clamp(r, 0, depth - 2);
+            }
+            score = -negamax(pos, depth - 1 - r, -alpha - 1, -alpha, 1);
+            if (score > alpha && r > 0) score = -negamax(pos, depth - 1, -alpha - 1, -alpha, 1);
+            if (score > alpha && score < beta) score = -negamax(pos, depth - 1, -beta, -alpha, 1);
+        }
+        unmake_move(pos, rm.move, st);
+        if (stopped) return bestScore;
+
+        rm.score = (moveCount == 1 || score > alpha) ? score : -VALUE_INFINITE;
+        if (moveCount == 1 || score > alpha) {
+            rm.pv[0] = rm.move;
+            std::copy(pvTable[1], pvTable[1] + pvLength[1], rm.pv + 1);
+            rm.pvLength = pvLength[1] + 1;
+        }
+        if (score > bestScore) bestScore = score;
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) break;
+    }
+    return bestScore;
+}
+
+// With the root in a bitbase, only the moves that keep its result are
+// searched; the search then picks among them by evaluation. Left alone if
+// any move leads out of the loaded tables.
+void SearchContext::Worker::filter_root_moves(board::Position& pos, std::vector<RootMove>& rootMoves) {
+    bitbase::Wdl rootWdl;
+    if (!bitbase::probe(pos, rootWdl)) return;
+    ++tbHits;
+    std::vector<RootMove> keep;
+    board::StateInfo st;
+    for (const RootMove& rm : rootMoves) {
+        bitbase::Wdl wdl;
+        pos.make_move(rm.move, st);
+        const bool found = bitbase::probe(pos, wdl);
+        pos.unmake_move(rm.move, st);
+        if (!found) return;
+        ++tbHits;
+        if (static_cast<int>(wdl) == -static_cast<int>(rootWdl)) keep.push_back(rm);
+    }
+    if (!keep.empty()) rootMoves = std::move(keep);
+}
+
+SearchResult SearchContext::Worker::think(board::Position& pos, const Limits& searchLimits, int moveOverheadMs) {
     SearchResult sr;
     movegen::MoveList legal;
     pos.generate_legal(legal);
     if (legal.size() == 0) { sr.bestMove = 0; return sr; }
 
-    g_nodes = 0;
-    movegen::Move bestMove = legal.moves.front();
-    int alpha = -30000, beta = 30000;
-    for (int d = 1; d <= limits.depth; ++d) {
-        int score = negamax(pos, d, alpha, beta, tt);
-        (void)score;
-        TTEntry tte;
-        if (tt.probe(pos.key(), tte) && tte.move != 0) bestMove = tte.move;
+    nodes = 0;
+    qnodes = 0;
+    evalCalls = 0;
+    ttProbes = 0;
+    ttHits = 0;
+    failHigh = 0;
+    failHighFirst = 0;
+    tbHits = 0;
+    tbMen = bitbase::max_men();
+    rootMaterial = pos.material_key();
+    evalState.pawns.probes = 0;
+    evalState.pawns.hits = 0;
+    evalState.network = eval::nnue::network();
+    evalState.accumulators.reset();
+    heur.clear_killers();
+    init_reductions();
+    tt.new_search();
+
+    // Initial root order: TT move, then the regular move ordering.
+    TTEntry tte{};
+    score_moves(pos, legal, tt.probe(pos.key(), tte) ? tte.move : 0, 0);
+    std::vector<RootMove> rootMoves;
+    rootMoves.reserve(legal.size());
+    for (std::size_t i = 0; i < legal.size(); ++i) {
+        pick_next(legal, i);
+        rootMoves.push_back(RootMove{legal.moves[i]});
+    }
+    if (tbMen) filter_root_moves(pos, rootMoves);
+
+    limits = searchLimits;
+    timer.start(limits, moveOverheadMs);
+    stopped = false;
+    pondering = limits.ponder && limits.ponder->load();
+
+    const int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+    const std::size_t multiPv = std::clamp<std::size_t>(static_cast<std::size_t>(std::max(limits.multiPv, 1)), 1, rootMoves.size());
+    const int window = params().aspirationWindow;
+    int score = 0;
+    for (int d = 1; d <= maxDepth; ++d) {
+        for (RootMove& rm : rootMoves) {
+            rm.previousScore = rm.score;
+            rm.score = -VALUE_INFINITE;
+        }
+        const movegen::Move previousBest = rootMoves.front().move;
+        const int previousScore = score;
+        selDepth = 0;
+
+        // MultiPV: line k is the best of the moves not already taken by
+        // lines 1..k-1, each with its own aspiration window around that
+        // move's previous score. All lines share the TT and history.
+        for (std::size_t pvIdx = 0; pvIdx < multiPv && !stopped; ++pvIdx) {
+            const int lineScore = rootMoves[pvIdx].previousScore;
+            int delta = window;
+            int alpha = -VALUE_INFINITE, beta = VALUE_INFINITE;
+            if (window > 0 && d >= 4 && lineScore > -VALUE_INFINITE) {
+                alpha = std::max(lineScore - delta, -VALUE_INFINITE);
+                beta = std::min(lineScore + delta, static_cast<int>(VALUE_INFINITE));
+            }
+            while (true) {
+                const int lineResult = root_search(pos, rootMoves, pvIdx, d, alpha, beta);
+                // An interrupted pass leaves the previous iteration's order in place.
+                if (stopped) break;
+                std::stable_sort(rootMoves.begin() + static_cast<std::ptrdiff_t>(pvIdx), rootMoves.end(),
+                                 [](const RootMove& a, const RootMove& b) { return a.score > b.score; });
+                if (lineResult <= alpha) {
+                    report(rootMoves[pvIdx], static_cast<int>(pvIdx) + 1, d, lineResult, alpha, beta);
+                    beta = (alpha + beta) / 2;
+                    alpha = std::max(lineResult - delta, -VALUE_INFINITE);
+                    ++sr.aspirationFails;
+                } else if (lineResult >= beta) {
+                    report(rootMoves[pvIdx], static_cast<int>(pvIdx) + 1, d, lineResult, alpha, beta);
+                    beta = std::min(lineResult + delta, static_cast<int>(VALUE_INFINITE));
+                    ++sr.aspirationFails;
+                } else {
+                    break;
+                }
+                delta += delta;
+            }
+            // Keep finished lines ordered; a later line can outscore an earlier one.
+            if (!stopped)
+                std::stable_sort(rootMoves.begin(), rootMoves.begin() + static_cast<std::ptrdiff_t>(pvIdx) + 1,
+                                 [](const RootMove& a, const RootMove& b) { return a.score > b.score; });
+        }
+        if (stopped) break;
+
+        score = rootMoves.front().score;
+        sr.depth = d;
+        sr.selDepth = selDepth;
+        sr.score = score;
+        for (std::size_t k = 0; k < multiPv; ++k)
+            report(rootMoves[k], static_cast<int>(k) + 1, d, rootMoves[k].score, -VALUE_INFINITE, VALUE_INFINITE);
+
+        poll_ponder();
+        if (pondering) continue;
+        // A single legal reply needs no thinking time beyond a sanity pass.
+        if (rootMoves.size() == 1 && timer.time_limited()) break;
+        if (d > 1 && timer.stop_after_iteration(rootMoves.front().move != previousBest, previousScore, score)) break;
+    }
+
+    sr.bestMove = rootMoves.front().move;
+    const RootMove& best = rootMoves.front();
+    sr.pv.assign(best.pv, best.pv + best.pvLength);
+    if (sr.pv.empty()) sr.pv.push_back(sr.bestMove);
+    // A line cut short by a TT cutoff still needs a ponder move; take the
+    // reply from the TT if it is legal.
+    if (sr.pv.size() == 1) {
+        board::StateInfo st;
+        if (pos.make_move(sr.bestMove, st)) {
+            TTEntry reply{};
+            movegen::MoveList replies;
+            pos.generate_legal(replies);
+            if (tt.probe(pos.key(), reply) && std::find(replies.begin(), replies.end(), reply.move) != replies.end())
+                sr.pv.push_back(reply.move);
+            pos.unmake_move(sr.bestMove, st);
+        }
     }
+    sr.nodes = nodes;
+    sr.qnodes = qnodes;
+    sr.evalCalls = evalCalls;
+    sr.ttProbes = ttProbes;
+    sr.ttHits = ttHits;
+    sr.pawnProbes = evalState.pawns.probes;
+    sr.pawnHits = evalState.pawns.hits;
+    sr.failHigh = failHigh;
+    sr.failHighFirst = failHighFirst;
+    sr.tbHits = tbHits;
+    sr.timeMs = timer.elapsed_ms();
+    return sr;
+}
+
+SearchResult SearchContext::Worker::solve_mate(board::Position& pos, const Limits& searchLimits, int moveOverheadMs) {
+    if (!mateSolver) mateSolver = std::make_unique<MateSolver>(MATE_HASH_MB);
+    const MateResult mate = mateSolver->solve(pos, searchLimits.mate, searchLimits, moveOverheadMs);
+
+    SearchResult sr;
+    sr.nodes = mate.nodes;
+    sr.timeMs = mate.timeMs;
+    if (!mate.mateIn || mate.pv.empty()) return sr;
+    sr.bestMove = mate.pv.front();
+    sr.pv = mate.pv;
+    sr.depth = sr.selDepth = 2 * mate.mateIn - 1;
+    sr.score = VALUE_MATE - sr.depth;
+    if (searchLimits.onInfo) {
+        SearchInfo info;
+        info.depth = info.selDepth = sr.depth;
+        info.score = sr.score;
+        info.nodes = sr.nodes;
+        info.timeMs = sr.timeMs;
+        info.pv = sr.pv;
+        searchLimits.onInfo(info);
+    }
+    return sr;
+}
+
+SearchContext::SearchContext(TranspositionTable& tt) : worker(std::make_unique<Worker>(tt)) {}
+
+SearchContext::~SearchContext() = default;
+
+void SearchContext::clear() {
+    worker->heur.clear();
+    worker->evalCache.clear();
+    worker->evalState.clear();
+    if (worker->mateSolver) worker->mateSolver->clear();
+}
+
+SearchResult SearchContext::think(board::Position& pos, const Limits& limits, int moveOverheadMs) {
+    if (limits.mate <= 0) return worker->think(pos, limits, moveOverheadMs);
+    const SearchResult mate = worker->solve_mate(pos, limits, moveOverheadMs);
+    if (mate.bestMove) return mate;
 
-    sr.bestMove = bestMove;
-    sr.nodes = g_nodes;
+    // No mate proven: a normal search on what is left of the limits still
+    // picks a move. Without any limit it stops at the mate horizon.
+    Limits rest = limits;
+    rest.mate = 0;
+    if (rest.timeMs > 0) rest.timeMs = std::max<int64_t>(1, rest.timeMs - mate.timeMs);
+    if (rest.moveTimeMs > 0) rest.moveTimeMs = std::max<int64_t>(1, rest.moveTimeMs - mate.timeMs);
+    if (rest.nodes > 0) rest.nodes = rest.nodes > mate.nodes ? rest.nodes - mate.nodes : 1;
+    if (!rest.depth && !rest.timeMs && !rest.moveTimeMs && !rest.nodes && !rest.infinite) rest.depth = 2 * limits.mate;
+    SearchResult sr = worker->think(pos, rest, moveOverheadMs);
+    sr.noMate = true;
+    sr.nodes += mate.nodes;
+    sr.timeMs += mate.timeMs;
     return sr;
 }
 
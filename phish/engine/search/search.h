@@ -1,54 +1,108 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "engine/util/types.h"
 #include "engine/movegen/move.h"
 #include "engine/board/position.h"
+#include "engine/search/tt.h"
 
 namespace phish::search {
 
-struct TTEntry {
-    U64 key;
-    int16_t score;
-    int16_t eval;
-    movegen::Move move;
-    uint16_t depth;
-    uint8_t flag; // 0=exact,1=alpha,2=beta
-    uint8_t age;
-};
-
-class TranspositionTable {
-public:
-    explicit TranspositionTable(std::size_t mb);
-    ~TranspositionTable();
-
-    void resize(std::size_t mb);
-    void clear();
+constexpr int MAX_PLY = 128;
+constexpr int VALUE_MATE = 30000;
+constexpr int VALUE_INFINITE = 30001;
+constexpr int VALUE_MATE_IN_MAX_PLY = VALUE_MATE - MAX_PLY;
+// Bitbase wins rank below every mate, less the ply they are found at.
+constexpr int VALUE_TB_WIN = VALUE_MATE_IN_MAX_PLY - 1;
+constexpr int VALUE_TB_WIN_IN_MAX_PLY = VALUE_TB_WIN - MAX_PLY;
+// Static eval slot of a TT entry whose node had none (side to move in check).
+constexpr int VALUE_NONE = 32002;
 
-    void store(U64 key, int depth, int score, int eval, uint8_t flag, movegen::Move move);
-    bool probe(U64 key, TTEntry& out) const;
-
-private:
-    TTEntry* table = nullptr;
-    std::size_t numEntries = 0;
-    uint8_t currentAge = 0;
+// Progress of the running search, reported after every root pass.
+struct SearchInfo {
+    int multiPv = 1; // 1-based line index
+    int depth = 0;
+    int selDepth = 0;
+    int score = 0;
+    bool lowerBound = false; // failed high: score is at least this
+    bool upperBound = false; // failed low: score is at most this
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+    int hashfull = 0; // permille
+    uint64_t tbHits = 0;
+    std::vector<movegen::Move> pv;
 };
 
 struct Limits {
-    int depth = 1;
-    int64_t timeMs = 0;
+    int depth = 0;          // 0 = no depth limit
+    int64_t timeMs = 0;     // clock of the side to move
     int64_t incMs = 0;
+    int movesToGo = 0;
+    int64_t moveTimeMs = 0;
+    uint64_t nodes = 0;     // 0 = no node limit
     bool infinite = false;
+    int multiPv = 1;        // number of best root lines to search
+    int mate = 0;           // > 0: prove a mate in at most this many moves before searching
+    // Set by another thread to end the search; polled alongside the clock.
+    const std::atomic<bool>* stop = nullptr;
+    // While this is set the search ignores the clock (go ponder). Clearing
+    // it (ponderhit) starts the clock from that moment.
+    const std::atomic<bool>* ponder = nullptr;
+    // Progress callbacks, invoked on the searching thread. Unset for silent
+    // searches such as bench.
+    std::function<void(const SearchInfo&)> onInfo;
+    std::function<void(int depth, movegen::Move move, int number)> onCurrMove;
 };
 
 struct SearchResult {
     movegen::Move bestMove = 0;
     std::vector<movegen::Move> pv;
+    int score = 0;
+    int depth = 0;
+    int selDepth = 0;
+    int aspirationFails = 0;
+    int64_t timeMs = 0;
     uint64_t nodes = 0;
+    uint64_t qnodes = 0;
+    uint64_t evalCalls = 0; // evaluate() calls not served by the TT or eval cache
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    uint64_t pawnProbes = 0;
+    uint64_t pawnHits = 0;
+    uint64_t failHigh = 0;
+    uint64_t failHighFirst = 0;
+    uint64_t tbHits = 0; // successful bitbase probes
+    bool noMate = false; // go mate found no mate; the move comes from a normal search
 };
 
-SearchResult think(board::Position& pos, const Limits& limits, TranspositionTable& tt);
+// One search engine instance: node counters, limits, clock, move stack, PV
+// and history tables all live here, only the TT is supplied by the caller.
+// Separate contexts may search concurrently on their own threads, each with
+// a private TT or sharing one; a single context runs one search at a time.
+class SearchContext {
+public:
+    explicit SearchContext(TranspositionTable& tt);
+    ~SearchContext();
+    SearchContext(const SearchContext&) = delete;
+    SearchContext& operator=(const SearchContext&) = delete;
+
+    // Reset move-ordering history, e.g. on ucinewgame.
+    void clear();
+
+    // Searches until the depth, node or time limit in `limits` is reached;
+    // `moveOverheadMs` is reserved from the clock for communication lag.
+    // With `limits.mate` set the mate solver runs first; if it proves no
+    // mate, a normal search spends the rest of the limits and sets noMate.
+    SearchResult think(board::Position& pos, const Limits& limits, int moveOverheadMs = 0);
+
+private:
+    struct Worker;
+    std::unique_ptr<Worker> worker;
+};
 
 } // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "engine/search/timeman.h"
+
+#include <algorithm>
+
+namespace phish::search {
+
+void TimeManager::start(const Limits& limits, int moveOverheadMs) {
+    startTime = std::chrono::steady_clock::now();
+    softMs = hardMs = 0;
+    stableIterations = 0;
+
+    if (limits.infinite) return;
+
+    if (limits.moveTimeMs > 0) {
+        softMs = hardMs = std::max<int64_t>(1, limits.moveTimeMs - moveOverheadMs);
+        return;
+    }
+    if (limits.timeMs <= 0) return;
+
+    // Spread the clock over the moves to the next control (or an assumed
+    // horizon in sudden death) and spend most of the increment now.
+    const int64_t movesToGo = limits.movesToGo > 0 ? std::min(limits.movesToGo, 50) : 30;
+    const int64_t available = std::max<int64_t>(1, limits.timeMs - moveOverheadMs);
+    softMs = std::max<int64_t>(1, available / movesToGo + limits.incMs * 3 / 4);
+    hardMs = std::min<int64_t>(available * 3 / 4, softMs * 5);
+    // Last move before the control: the clock is all ours, but keep a margin.
+    if (movesToGo == 1) hardMs = available * 9 / 10;
+    hardMs = std::max<int64_t>(1, hardMs);
+    softMs = std::min(softMs, hardMs);
+}
+
+bool TimeManager::stop_after_iteration(bool bestMoveChanged, int previousScore, int score) {
+    if (!time_limited() || softMs == hardMs) return false;
+
+    stableIterations = bestMoveChanged ? 0 : stableIterations + 1;
+
+    // An unstable best move or a falling score earns more time; a best move
+    // that survived several iterations lets us stop early.
+    double scale = 1.0;
+    if (bestMoveChanged) scale = 1.4;
+    else if (stableIterations >= 4) scale = 0.6;
+    else if (stableIterations >= 2) scale = 0.8;
+
+    const int drop = previousScore - score;
+    if (drop > 20) scale *= std::min(1.0 + drop / 100.0, 1.6);
+
+    return elapsed_ms() >= static_cast<int64_t>(softMs * scale);
+}
+
+} // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "engine/search/search.h"
+
+namespace phish::search {
+
+// Turns UCI clock limits into a soft deadline (checked between iterations
+// and scaled by best-move stability and score trend) and a hard deadline
+// (polled inside the search).
+class TimeManager {
+public:
+    void start(const Limits& limits, int moveOverheadMs);
+
+    int64_t elapsed_ms() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    // Restart the clock, keeping the allocation (ponderhit).
+    void restart() { startTime = std::chrono::steady_clock::now(); }
+
+    bool time_limited() const { return hardMs > 0; }
+    int64_t soft_ms() const { return softMs; }
+    int64_t hard_ms() const { return hardMs; }
+
+    bool hard_limit_reached() const { return time_limited() && elapsed_ms() >= hardMs; }
+
+    // Called after each completed iteration. Returns true if another
+    // iteration is not worth starting.
+    bool stop_after_iteration(bool bestMoveChanged, int previousScore, int score);
+
+private:
+    std::chrono::steady_clock::time_point startTime;
+    int64_t softMs = 0;
+    int64_t hardMs = 0;
+    int stableIterations = 0;
+};
+
+} // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "engine/search/tt.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace phish::search {
+
+namespace {
+
+// Data word layout:
+//   bits  0-19 move (from, to, promo and flag bits)
+//   bits 20-35 score
+//   bits 36-51 static eval
+//   bits 52-59 depth + DEPTH_OFFSET (0 marks an empty slot)
+//   bits 60-61 bound
+// Key word (before XOR with data): bits 0-15 key check, bits 16-23 generation.
+constexpr int DEPTH_OFFSET = 4;
+constexpr U64 MOVE_MASK = (1ULL << 20) - 1;
+
+inline U64 pack_data(movegen::Move move, int score, int eval, int depth, uint8_t flag) {
+    const int d = std::clamp(depth + DEPTH_OFFSET, 1, 255);
+    U64 w = static_cast<U64>(move) & MOVE_MASK;
+    w |= static_cast<U64>(static_cast<uint16_t>(score)) << 20;
+    w |= static_cast<U64>(static_cast<uint16_t>(eval)) << 36;
+    w |= static_cast<U64>(d) << 52;
+    w |= static_cast<U64>(flag & 3) << 60;
+    return w;
+}
+
+inline movegen::Move data_move(U64 w) { return static_cast<movegen::Move>(w & MOVE_MASK); }
+inline int16_t data_score(U64 w) { return static_cast<int16_t>((w >> 20) & 0xFFFF); }
+inline int16_t data_eval(U64 w) { return static_cast<int16_t>((w >> 36) & 0xFFFF); }
+inline int data_depth8(U64 w) { return static_cast<int>((w >> 52) & 0xFF); }
+inline uint8_t data_flag(U64 w) { return static_cast<uint8_t>((w >> 60) & 3); }
+
+inline U64 pack_key(uint16_t key16, uint8_t gen) { return static_cast<U64>(key16) | (static_cast<U64>(gen) << 16); }
+inline uint16_t key_check(U64 k) { return static_cast<uint16_t>(k); }
+inline uint8_t key_gen(U64 k) { return static_cast<uint8_t>(k >> 16); }
+
+// Bits above the generation are always zero in a consistent slot, so a
+// slot whose words come from two different stores is rejected with high
+// probability even when the 16-bit check happens to match.
+inline bool key_sane(U64 k) { return (k >> 24) == 0; }
+
+} // namespace
+
+TranspositionTable::TranspositionTable(std::size_t mb) { resize(mb); }
+TranspositionTable::~TranspositionTable() { memory::free_large(block); }
+
+bool TranspositionTable::resize(std::size_t mb, int threads) {
+    if (clusters && mb == sizeMb) return true;
+
+    std::size_t bytes = mb * 1024ULL * 1024ULL;
+    std::size_t count = bytes / sizeof(Cluster);
+    if (count == 0) count = 1;
+    memory::LargeBlock fresh = memory::allocate_large(count * sizeof(Cluster));
+    if (!fresh.ptr) return false;
+    memory::free_large(block);
+    block = fresh;
+
+    // Slots are plain atomics over zeroed storage; the memory is left untouched
+    // until clear() so the clearing threads get first-touch placement.
+    clusters = static_cast<Cluster*>(block.ptr);
+    numClusters = count;
+    sizeMb = mb;
+    clear(threads);
+    return true;
+}
+
+void TranspositionTable::clear(int threads) {
+    if (!clusters) return;
+    const std::size_t workers = static_cast<std::size_t>(std::clamp(threads, 1, 256));
+    auto zero = [this, workers](std::size_t idx) {
+        const std::size_t stride = numClusters / workers;
+        const std::size_t begin = idx * stride;
+        const std::size_t len = (idx + 1 == workers) ? numClusters - begin : stride;
+        std::memset(static_cast<void*>(clusters + begin), 0, len * sizeof(Cluster));
+    };
+    if (workers == 1 || numClusters < workers) {
+        std::memset(static_cast<void*>(clusters), 0, numClusters * sizeof(Cluster));
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (std::size_t i = 1; i < workers; ++i) pool.emplace_back(zero, i);
+        zero(0);
+        for (auto& t : pool) t.join();
+    }
+    generation.store(0, std::memory_order_relaxed);
+}
+
+void TranspositionTable::store(U64 key, int depth, int score, int eval, uint8_t flag, movegen::Move move) {
+    if (!clusters) return;
+    const uint16_t key16 = static_cast<uint16_t>(key);
+    Cluster* c = first_cluster(key);
+
+    const uint8_t gen = generation.load(std::memory_order_relaxed);
+    Slot* replace = nullptr;
+    int replaceWorth = INT_MAX;
+    for (Slot& s : c->slots) {
+        const U64 d = s.data.load(std::memory_order_relaxed);
+        const U64 k = s.keyWord.load(std::memory_order_relaxed) ^ d;
+        if (data_depth8(d) == 0) {
+            replace = &s;
+            break;
+        }
+        if (key_check(k) == key16 && key_sane(k)) {
+            // Same position: keep the old move if we have none, and do not let a
+            // much shallower non-exact result evict a deeper one from this search.
+            if (move == 0) move = data_move(d);
+            if (flag != 0 && key_gen(k) == gen && depth + DEPTH_OFFSET + 3 < data_depth8(d)) return;
+            replace = &s;
+            break;
+        }
+        // Prefer evicting shallow entries from old searches; exact bounds are kept longer.
+        const int age = static_cast<uint8_t>(gen - key_gen(k));
+        const int worth = data_depth8(d) - 8 * age + (data_flag(d) == 0 ? 2 : 0);
+        if (worth < replaceWorth) {
+            replaceWorth = worth;
+            replace = &s;
+        }
+    }
+
+    const U64 d = pack_data(move, score, eval, depth, flag);
+    replace->data.store(d, std::memory_order_relaxed);
+    replace->keyWord.store(pack_key(key16, gen) ^ d, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::probe(U64 key, TTEntry& out) const {
+    if (!clusters) return false;
+    const uint16_t key16 = static_cast<uint16_t>(key);
+    const Cluster* c = first_cluster(key);
+    for (const Slot& s : c->slots) {
+        const U64 d = s.data.load(std::memory_order_relaxed);
+        const U64 k = s.keyWord.load(std::memory_order_relaxed) ^ d;
+        if (data_depth8(d) == 0 || key_check(k) != key16 || !key_sane(k)) continue;
+        out.move = data_move(d);
+        out.score = data_score(d);
+        out.eval = data_eval(d);
+        out.depth = data_depth8(d) - DEPTH_OFFSET;
+        out.flag = data_flag(d);
+        out.age = key_gen(k);
+        return true;
+    }
+    return false;
+}
+
+int TranspositionTable::hashfull() const {
+    if (!clusters) return 0;
+    const std::size_t samples = std::min<std::size_t>(1000 / CLUSTER_SIZE, numClusters);
+    const uint8_t gen = generation.load(std::memory_order_relaxed);
+    int used = 0;
+    for (std::size_t i = 0; i < samples; ++i) {
+        for (const Slot& s : clusters[i].slots) {
+            const U64 d = s.data.load(std::memory_order_relaxed);
+            const U64 k = s.keyWord.load(std::memory_order_relaxed) ^ d;
+            if (data_depth8(d) != 0 && key_gen(k) == gen) ++used;
+        }
+    }
+    return static_cast<int>(used * 1000 / (samples * CLUSTER_SIZE));
+}
+
+} // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "engine/util/types.h"
+#include "engine/movegen/move.h"
+#include "engine/util/memory.h"
+
+namespace phish::search {
+
+// Decoded view of a TT slot as returned by probe().
+struct TTEntry {
+    int16_t score = 0;
+    int16_t eval = 0;
+    movegen::Move move = 0;
+    int depth = 0;
+    uint8_t flag = 0; // 0=exact,1=alpha,2=beta
+    uint8_t age = 0;
+};
+
+// Shared, lock-free transposition table.
+//
+// The table is an array of 64-byte clusters holding four 16-byte slots. A
+// slot is two relaxed atomic words: a data word (move, score, eval, depth,
+// bound) and a key word (16-bit key check + generation) stored XOR-ed with
+// the data word. A torn write from a concurrent store then fails the key
+// check instead of returning mixed data.
+class TranspositionTable {
+public:
+    static constexpr int CLUSTER_SIZE = 4;
+
+    explicit TranspositionTable(std::size_t mb);
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Reallocates only when the size actually changes. The new table is
+    // cleared by `threads` workers so each touches its own slice first.
+    // False when the allocation fails; the previous table is then kept.
+    bool resize(std::size_t mb, int threads = 1);
+    void clear(int threads = 1);
+
+    std::size_t size_mb() const { return sizeMb; }
+    memory::PageKind page_kind() const { return block.kind; }
+
+    // Advance the generation; entries from older searches become preferred
+    // replacement victims. Searches sharing the table may call this
+    // concurrently.
+    void new_search() { generation.fetch_add(1, std::memory_order_relaxed); }
+
+    void store(U64 key, int depth, int score, int eval, uint8_t flag, movegen::Move move);
+    bool probe(U64 key, TTEntry& out) const;
+
+    // Pull the cluster for `key` into cache ahead of a probe or store.
+    void prefetch(U64 key) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(first_cluster(key));
+#else
+        (void)key;
+#endif
+    }
+
+    // Permille of sampled slots written during the current search.
+    int hashfull() const;
+
+private:
+    struct Slot {
+        std::atomic<U64> keyWord;
+        std::atomic<U64> data;
+    };
+
+    struct alignas(64) Cluster {
+        Slot slots[CLUSTER_SIZE];
+    };
+
+    static_assert(sizeof(Cluster) == 64, "TT cluster must fill one cache line");
+
+    // Multiply-shift maps the key uniformly onto [0, numClusters) without a division.
+    Cluster* first_cluster(U64 key) const {
+        __extension__ typedef unsigned __int128 U128;
+        return &clusters[static_cast<std::size_t>((static_cast<U128>(key) * numClusters) >> 64)];
+    }
+
+    memory::LargeBlock block;
+    Cluster* clusters = nullptr;
+    std::size_t numClusters = 0;
+    std::size_t sizeMb = 0;
+    std::atomic<uint8_t> generation{0};
+};
+
+} // namespace phish::search
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "engine/tools/bitbases.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+#include "engine/bitbase/bitbase.h"
+#include "engine/bitbase/generate.h"
+#include "engine/bitboard/bitboard.h"
+#include "engine/util/zobrist.h"
+
+namespace phish::tools {
+
+namespace {
+
+// Generates `m` after the tables it depends on, unless it is loaded.
+bool build(const bitbase::Material& m, const std::string& dir, int threads) {
+    if (bitbase::loaded(m)) return true;
+    for (const bitbase::Material& next : bitbase::successors(m))
+        if (!build(next, dir, threads)) return false;
+
+    const std::string path = (std::filesystem::path(dir) / (m.name() + ".pbb")).string();
+    bitbase::GenerateStats stats;
+    std::string error;
+    if (!bitbase::generate(m, path, threads, stats, error) || !bitbase::load_file(path, error)) {
+        std::cerr << m.name() << ": " << error << "\n";
+        return false;
+    }
+    std::cerr << m.name() << ": " << stats.positions << " positions, " << stats.wins << " wins, " << stats.draws
+              << " draws, " << stats.losses << " losses, " << stats.passes << " passes, " << stats.seconds
+              << " s\n";
+    return true;
+}
+
+} // namespace
+
+int bitbases(const std::vector<std::string>& args) {
+    std::string dir;
+    std::vector<bitbase::Material> targets;
+    int threads = 0;
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        bitbase::Material m;
+        if (args[i] == "threads" && i + 1 < args.size()) {
+            threads = std::atoi(args[++i].c_str());
+        } else if (dir.empty()) {
+            dir = args[i];
+        } else if (args[i] == "all") {
+            const std::vector<bitbase::Material> all = bitbase::all_materials();
+            targets.insert(targets.end(), all.begin(), all.end());
+        } else if (bitbase::parse_material(args[i], m)) {
+            targets.push_back(m);
+        } else {
+            std::cerr << "not a bitbase material: " << args[i] << "\n";
+            return 1;
+        }
+    }
+    if (dir.empty()) {
+        std::cerr << "usage: phish bitbases <dir> [all | MATERIAL...] [threads N]\n";
+        return 1;
+    }
+    if (targets.empty()) targets = bitbase::all_materials();
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    bitboard::init();
+    zobrist::init();
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::string message;
+    bitbase::load(dir, message);
+    std::cerr << message << "\n";
+    for (const bitbase::Material& m : targets)
+        if (!build(m, dir, threads)) return 1;
+    return 0;
+}
+
+} // namespace phish::tools
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace phish::tools {
+
+// `phish bitbases <dir> [all | MATERIAL...] [threads N]`: generates the
+// endgame bitbases named (KQvKR, KPvK, ...; default all up to
+// bitbase::MAX_MEN men) into `dir`, together with every smaller table they
+// depend on. Tables already in `dir` are loaded rather than generated
+// again. Returns the process exit code.
+int bitbases(const std::vector<std::string>& args);
+
+} // namespace phish::tools
\ No newline at end of file
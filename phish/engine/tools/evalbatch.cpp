@@ -0,0 +1,196 @@
+#include "engine/tools/evalbatch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "engine/util/config.h"
+#include "engine/bitboard/bitboard.h"
+#include "engine/board/position.h"
+#include "engine/eval/evaluate.h"
+#include "engine/util/parallel.h"
+#include "engine/util/zobrist.h"
+
+namespace phish::tools {
+
+namespace {
+
+// Records are board::PackedPosition.
+constexpr std::size_t RECORD_BYTES = sizeof(board::PackedPosition);
+using Record = board::PackedPosition;
+
+constexpr int16_t INVALID_SCORE = INT16_MIN;
+
+// Inputs read, evaluated and written per round.
+constexpr std::size_t CHUNK = 1 << 14;
+
+// set_fen accepts boards the evaluation cannot handle; it needs one king
+// per side.
+bool parse(const std::string& fen, board::Position& pos) {
+    return pos.set_fen(fen) && pos.count(W_KING) == 1 && pos.count(B_KING) == 1;
+}
+
+// A record holds at most 32 men; pack() refuses larger boards.
+bool pack(const std::string& fen, Record& rec) {
+    board::Position pos;
+    return parse(fen, pos) && pos.pack(rec);
+}
+
+bool unpack(const Record& rec, board::Position& pos) {
+    return pos.set_packed(rec) && pos.count(W_KING) == 1 && pos.count(B_KING) == 1;
+}
+
+struct Settings {
+    std::string input;
+    bool packed = false;
+    bool packOnly = false;
+    bool classical = false;
+    int threads = 0;
+    std::string evalFile;
+};
+
+int run_pack(std::istream& in) {
+    std::string line;
+    uint64_t written = 0, invalid = 0;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        Record rec;
+        if (!pack(line, rec)) {
+            ++invalid;
+            continue;
+        }
+        std::fwrite(rec.bytes, 1, RECORD_BYTES, stdout);
+        ++written;
+    }
+    std::cerr << "packed " << written << " positions, skipped " << invalid << " invalid lines\n";
+    return 0;
+}
+
+// One round's inputs and results. Each thread decodes and evaluates its
+// own contiguous slice, so the output keeps the input order.
+struct Chunk {
+    std::vector<std::string> lines;
+    std::vector<Record> records;
+    std::vector<board::Position> positions;
+    std::vector<char> valid;
+    std::vector<int> scores;
+};
+
+void evaluate_slice(Chunk& chunk, bool packed, std::size_t begin, std::size_t end, eval::EvalState& state) {
+    for (std::size_t i = begin; i < end; ++i) {
+        board::Position& pos = chunk.positions[i];
+        chunk.valid[i] = packed ? unpack(chunk.records[i], pos) : parse(chunk.lines[i], pos);
+        // Something the evaluation can take; its score is not written.
+        if (!chunk.valid[i]) pos.set_startpos();
+    }
+    eval::evaluate_batch(std::span<const board::Position>(chunk.positions).subspan(begin, end - begin),
+                         std::span<int>(chunk.scores).subspan(begin, end - begin), state);
+}
+
+} // namespace
+
+int evalbatch(const std::vector<std::string>& args) {
+    Settings settings;
+    settings.evalFile = options().evalFile;
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "packed") settings.packed = true;
+        else if (args[i] == "pack") settings.packOnly = true;
+        else if (args[i] == "classical") settings.classical = true;
+        else if (args[i] == "threads" && i + 1 < args.size()) settings.threads = std::atoi(args[++i].c_str());
+        else if (args[i] == "evalfile" && i + 1 < args.size()) settings.evalFile = args[++i];
+        else if (settings.input.empty()) settings.input = args[i];
+    }
+    if (settings.input.empty()) {
+        std::cerr << "usage: phish evalbatch <file|-> [packed] [pack] [threads N] [evalfile PATH] [classical]\n";
+        return 1;
+    }
+
+    std::ios::sync_with_stdio(false);
+    std::ifstream file;
+    if (settings.input != "-") {
+        file.open(settings.input, std::ios::binary);
+        if (!file) {
+            std::cerr << "cannot open " << settings.input << "\n";
+            return 1;
+        }
+    }
+    std::istream& in = settings.input == "-" ? std::cin : file;
+
+    bitboard::init();
+    zobrist::init();
+    if (settings.packOnly) return run_pack(in);
+
+    if (!settings.classical) {
+        std::string message;
+        eval::nnue::set_network(eval::nnue::load_eval_file(settings.evalFile, message));
+        std::cerr << message << "\n";
+    }
+
+    const int threads = settings.threads > 0 ? settings.threads
+                                             : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::unique_ptr<eval::EvalState>> states;
+    for (int t = 0; t < threads; ++t) {
+        states.push_back(std::make_unique<eval::EvalState>());
+        states.back()->network = eval::nnue::network();
+    }
+
+    Chunk chunk;
+    chunk.positions.resize(CHUNK);
+    chunk.valid.resize(CHUNK);
+    chunk.scores.resize(CHUNK);
+    std::string out;
+    uint64_t total = 0, invalid = 0;
+    std::streamsize tail = 0; // bytes of a trailing partial record
+    const auto start = std::chrono::steady_clock::now();
+    while (true) {
+        std::size_t n = 0;
+        if (settings.packed) {
+            chunk.records.resize(CHUNK);
+            while (n < CHUNK && in.read(reinterpret_cast<char*>(chunk.records[n].bytes), RECORD_BYTES)) ++n;
+            if (n < CHUNK && in.gcount() > 0) tail = in.gcount();
+        } else {
+            chunk.lines.resize(CHUNK);
+            while (n < CHUNK && std::getline(in, chunk.lines[n])) ++n;
+        }
+        if (n == 0) break;
+
+        parallel(threads, n, [&](std::size_t begin, std::size_t end, int t) {
+            evaluate_slice(chunk, settings.packed, begin, end, *states[t]);
+        });
+
+        out.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!chunk.valid[i]) ++invalid;
+            if (settings.packed) {
+                const int16_t v = chunk.valid[i] ? static_cast<int16_t>(chunk.scores[i]) : INVALID_SCORE;
+                out += static_cast<char>(v & 0xFF);
+                out += static_cast<char>((v >> 8) & 0xFF);
+            } else {
+                out += chunk.valid[i] ? std::to_string(chunk.scores[i]) : "invalid";
+                out += '\n';
+            }
+        }
+        std::fwrite(out.data(), 1, out.size(), stdout);
+        total += n;
+    }
+    std::fflush(stdout);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "evaluated " << total << " positions (" << invalid << " invalid) in " << seconds << " s, "
+              << static_cast<uint64_t>(static_cast<double>(total) / std::max(seconds, 1e-9)) << " positions/s, "
+              << threads << " threads\n";
+    // A truncated input must not look like a complete run to a pipeline.
+    if (tail > 0) {
+        std::cerr << "input ends with a partial record of " << tail << " bytes\n";
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace phish::tools
\ No newline at end of file
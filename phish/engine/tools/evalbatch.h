@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace phish::tools {
+
+// `phish evalbatch <file|-> [packed] [pack] [threads N] [evalfile PATH] [classical]`:
+// static evaluations for a stream of positions, in input order.
+//
+// Text input has one FEN per line and gives one score per line (side to
+// move's point of view, "invalid" for a bad FEN). With `packed`, input is
+// 32-byte board::PackedPosition records and output one little-endian
+// int16 per record, -32768 for an invalid one. `pack` converts FEN lines
+// to records instead of evaluating them. Returns the process exit code.
+int evalbatch(const std::vector<std::string>& args);
+
+} // namespace phish::tools
\ No newline at end of file
@@ -0,0 +1,407 @@
+#include "engine/tools/tune.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include "engine/bitboard/bitboard.h"
+#include "engine/board/position.h"
+#include "engine/eval/evaluate.h"
+#include "engine/eval/trace.h"
+#include "engine/util/parallel.h"
+#include "engine/util/zobrist.h"
+
+namespace phish::tools {
+
+namespace {
+
+using eval::TraceTerm;
+using eval::WEIGHT_NB;
+
+constexpr int MAX_QPLY = 32;
+
+struct Settings {
+    std::string input;
+    std::string out = "weights.h";
+    int threads = 0;
+    int epochs = 1000;
+    double lr = 1.0;
+    std::size_t batch = 0; // 0: all positions per step
+    double k = 0.0;        // 0: fitted
+    std::size_t limit = 0;
+    int report = 100;
+    bool qsearch = true;
+};
+
+// One traced position. The evaluation, White's point of view, is the sum
+// over its terms of coeff * (mgScale * mg + egScale * eg).
+struct Sample {
+    uint32_t begin;
+    uint16_t count;
+    float result;
+    float mgScale;
+    float egScale;
+};
+
+struct Dataset {
+    std::vector<Sample> samples;
+    std::vector<TraceTerm> terms;
+};
+
+struct Weights {
+    double mg[WEIGHT_NB];
+    double eg[WEIGHT_NB];
+};
+
+// Game result from White's point of view in the text after a FEN, or -1.
+double parse_result(std::istringstream& rest) {
+    std::string token;
+    while (rest >> token) {
+        if (token == "1-0") return 1.0;
+        if (token == "0-1") return 0.0;
+        if (token == "1/2-1/2") return 0.5;
+        if (token.find('.') == std::string::npos) continue;
+        char* end = nullptr;
+        const double value = std::strtod(token.c_str(), &end);
+        if (*end == '\0' && value >= 0.0 && value <= 1.0) return value;
+    }
+    return -1.0;
+}
+
+// FEN (four fields, plus the clocks if present) and result of one line.
+bool parse_line(std::string line, std::string& fen, double& result) {
+    for (char& ch : line)
+        if (ch == '[' || ch == ']' || ch == '"' || ch == ';' || ch == ',' || ch == '|') ch = ' ';
+    std::istringstream fields(line);
+    std::string field;
+    fen.clear();
+    for (int i = 0; i < 4 && fields >> field; ++i) fen += (i ? " " : "") + field;
+    for (int i = 0; i < 2; ++i) {
+        const auto mark = fields.tellg();
+        if (!(fields >> field) || field.find_first_not_of("0123456789") != std::string::npos) {
+            fields.clear();
+            fields.seekg(mark);
+            break;
+        }
+        fen += " " + field;
+    }
+    result = parse_result(fields);
+    return result >= 0.0;
+}
+
+struct Line {
+    movegen::Move moves[MAX_QPLY];
+    int length = 0;
+};
+
+int victim_value(const board::Position& pos, movegen::Move m) {
+    if (movegen::is_enpassant(m)) return PAWN;
+    const int pc = pos.piece_at(movegen::to_sq(m));
+    return pc == NO_PIECE ? 0 : pc % 6;
+}
+
+// Captures and promotions that do not lose material, most valuable victim
+// first, with stand pat; `pv` receives the line to the quiet position.
+int qsearch(board::Position& pos, eval::EvalState& state, int alpha, int beta, int ply, Line& pv) {
+    pv.length = 0;
+    const int standPat = eval::evaluate(pos, state);
+    if (standPat >= beta || ply >= MAX_QPLY) return standPat;
+    alpha = std::max(alpha, standPat);
+
+    movegen::MoveList moves;
+    pos.generate_captures(moves);
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const movegen::Move m = moves.moves[i];
+        moves.scores[i] = victim_value(pos, m) * 8 - pos.piece_at(movegen::from_sq(m)) % 6 +
+                          (movegen::is_promotion(m) ? 64 : 0);
+    }
+    Line child;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        std::size_t best = i;
+        for (std::size_t j = i + 1; j < moves.size(); ++j)
+            if (moves.scores[j] > moves.scores[best]) best = j;
+        std::swap(moves.moves[i], moves.moves[best]);
+        std::swap(moves.scores[i], moves.scores[best]);
+        const movegen::Move m = moves.moves[i];
+        if (!pos.see_ge(m)) continue;
+        board::StateInfo st;
+        if (!pos.make_move(m, st)) continue;
+        const int score = -qsearch(pos, state, -beta, -alpha, ply + 1, child);
+        pos.unmake_move(m, st);
+        if (score > alpha) {
+            alpha = score;
+            pv.moves[0] = m;
+            std::copy(child.moves, child.moves + child.length, pv.moves + 1);
+            pv.length = child.length + 1;
+            if (score >= beta) break;
+        }
+    }
+    return alpha;
+}
+
+// Traces the quiet position `pos` resolves to. False for positions in
+// check, which stand pat cannot judge, and for the ones the endgame
+// evaluators score.
+bool resolve(board::Position& pos, eval::EvalState& state, bool quiesce, eval::EvalTrace& trace) {
+    if (pos.in_check()) return false;
+    Line pv;
+    if (quiesce) qsearch(pos, state, -eval::VALUE_KNOWN_WIN, eval::VALUE_KNOWN_WIN, 0, pv);
+    board::StateInfo states[MAX_QPLY];
+    for (int i = 0; i < pv.length; ++i) pos.make_move(pv.moves[i], states[i]);
+    const bool ok = eval::trace(pos, state, trace);
+    for (int i = pv.length - 1; i >= 0; --i) pos.unmake_move(pv.moves[i], states[i]);
+    return ok;
+}
+
+Dataset load_slice(const std::vector<std::string>& lines, std::size_t begin, std::size_t end, bool quiesce,
+                   std::size_t& skipped) {
+    Dataset data;
+    auto state = std::make_unique<eval::EvalState>();
+    eval::EvalTrace trace;
+    std::string fen;
+    for (std::size_t i = begin; i < end; ++i) {
+        double result = 0.0;
+        board::Position pos;
+        if (!parse_line(lines[i], fen, result) || !pos.set_fen(fen) || pos.count(W_KING) != 1 ||
+            pos.count(B_KING) != 1 || !resolve(pos, *state, quiesce, trace)) {
+            ++skipped;
+            continue;
+        }
+        Sample s;
+        s.begin = static_cast<uint32_t>(data.terms.size());
+        s.count = static_cast<uint16_t>(trace.terms.size());
+        s.result = static_cast<float>(result);
+        s.mgScale = static_cast<float>(trace.phase) / eval::PHASE_MAX;
+        s.egScale = static_cast<float>(eval::PHASE_MAX - trace.phase) / eval::PHASE_MAX * trace.scale /
+                    eval::SCALE_NORMAL;
+        data.samples.push_back(s);
+        data.terms.insert(data.terms.end(), trace.terms.begin(), trace.terms.end());
+    }
+    return data;
+}
+
+double evaluate(const Dataset& data, const Sample& s, const Weights& w) {
+    double value = 0.0;
+    for (const TraceTerm* t = &data.terms[s.begin]; t != &data.terms[s.begin] + s.count; ++t)
+        value += t->coeff * (s.mgScale * w.mg[t->index] + s.egScale * w.eg[t->index]);
+    return value;
+}
+
+double sigmoid(double k, double value) { return 1.0 / (1.0 + std::pow(10.0, -k * value / 400.0)); }
+
+double mean_error(const Dataset& data, const Weights& w, double k, int threads) {
+    std::vector<double> sums(threads);
+    parallel(threads, data.samples.size(), [&](std::size_t begin, std::size_t end, int t) {
+        double sum = 0.0;
+        for (std::size_t i = begin; i < end; ++i) {
+            const double error = data.samples[i].result - sigmoid(k, evaluate(data, data.samples[i], w));
+            sum += error * error;
+        }
+        sums[t] = sum;
+    });
+    double total = 0.0;
+    for (const double s : sums) total += s;
+    return total / static_cast<double>(std::max<std::size_t>(data.samples.size(), 1));
+}
+
+// Golden-section search for the K that fits the current weights best.
+double fit_k(const Dataset& data, const Weights& w, int threads) {
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double lo = 0.05, hi = 5.0;
+    double a = hi - ratio * (hi - lo), b = lo + ratio * (hi - lo);
+    double ea = mean_error(data, w, a, threads), eb = mean_error(data, w, b, threads);
+    for (int i = 0; i < 40; ++i) {
+        if (ea < eb) {
+            hi = b;
+            b = a;
+            eb = ea;
+            a = hi - ratio * (hi - lo);
+            ea = mean_error(data, w, a, threads);
+        } else {
+            lo = a;
+            a = b;
+            ea = eb;
+            b = lo + ratio * (hi - lo);
+            eb = mean_error(data, w, b, threads);
+        }
+    }
+    return (lo + hi) / 2.0;
+}
+
+// Gradient of the mean squared error over samples[begin, end), summed per
+// thread and then reduced.
+void gradient(const Dataset& data, std::size_t begin, std::size_t end, const Weights& w, double k, int threads,
+              Weights& grad) {
+    std::vector<Weights> partial(threads);
+    const double slope = k * std::log(10.0) / 400.0;
+    const double norm = 2.0 / static_cast<double>(end - begin);
+    parallel(threads, end - begin, [&](std::size_t first, std::size_t last, int t) {
+        Weights& g = partial[t];
+        std::fill(std::begin(g.mg), std::end(g.mg), 0.0);
+        std::fill(std::begin(g.eg), std::end(g.eg), 0.0);
+        for (std::size_t i = begin + first; i < begin + last; ++i) {
+            const Sample& s = data.samples[i];
+            const double p = sigmoid(k, evaluate(data, s, w));
+            const double d = (p - s.result) * p * (1.0 - p) * slope * norm;
+            for (const TraceTerm* term = &data.terms[s.begin]; term != &data.terms[s.begin] + s.count; ++term) {
+                g.mg[term->index] += d * term->coeff * s.mgScale;
+                g.eg[term->index] += d * term->coeff * s.egScale;
+            }
+        }
+    });
+    grad = partial[0];
+    for (int t = 1; t < threads; ++t) {
+        for (int i = 0; i < WEIGHT_NB; ++i) {
+            grad.mg[i] += partial[t].mg[i];
+            grad.eg[i] += partial[t].eg[i];
+        }
+    }
+}
+
+struct Adam {
+    static constexpr double BETA1 = 0.9;
+    static constexpr double BETA2 = 0.999;
+    static constexpr double EPSILON = 1e-8;
+
+    Weights m{};
+    Weights v{};
+    int steps = 0;
+
+    void step(Weights& w, const Weights& grad, double lr) {
+        ++steps;
+        const double c1 = 1.0 - std::pow(BETA1, steps);
+        const double c2 = 1.0 - std::pow(BETA2, steps);
+        auto update = [&](double* param, double* mean, double* var, const double* g) {
+            for (int i = 0; i < WEIGHT_NB; ++i) {
+                mean[i] = BETA1 * mean[i] + (1.0 - BETA1) * g[i];
+                var[i] = BETA2 * var[i] + (1.0 - BETA2) * g[i] * g[i];
+                param[i] -= lr * (mean[i] / c1) / (std::sqrt(var[i] / c2) + EPSILON);
+            }
+        };
+        update(w.mg, m.mg, v.mg, grad.mg);
+        update(w.eg, m.eg, v.eg, grad.eg);
+    }
+};
+
+bool write_header(const std::string& path, const Weights& w) {
+    int mg[WEIGHT_NB], eg[WEIGHT_NB];
+    for (int i = 0; i < WEIGHT_NB; ++i) {
+        mg[i] = static_cast<int>(std::lround(w.mg[i]));
+        eg[i] = static_cast<int>(std::lround(w.eg[i]));
+    }
+    std::ofstream out(path, std::ios::binary);
+    out << eval::weights_header(mg, eg);
+    return static_cast<bool>(out);
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int tune(const std::vector<std::string>& args) {
+    Settings settings;
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const bool hasValue = i + 1 < args.size();
+        if (args[i] == "noqsearch") settings.qsearch = false;
+        else if (args[i] == "threads" && hasValue) settings.threads = std::atoi(args[++i].c_str());
+        else if (args[i] == "epochs" && hasValue) settings.epochs = std::atoi(args[++i].c_str());
+        else if (args[i] == "lr" && hasValue) settings.lr = std::atof(args[++i].c_str());
+        else if (args[i] == "batch" && hasValue) settings.batch = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (args[i] == "k" && hasValue) settings.k = std::atof(args[++i].c_str());
+        else if (args[i] == "limit" && hasValue) settings.limit = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (args[i] == "report" && hasValue) settings.report = std::max(1, std::atoi(args[++i].c_str()));
+        else if (args[i] == "out" && hasValue) settings.out = args[++i];
+        else if (settings.input.empty()) settings.input = args[i];
+    }
+    if (settings.input.empty()) {
+        std::cerr << "usage: phish_tune <file> [threads N] [epochs N] [lr X] [batch N] [k X] [limit N] [report N]"
+                     " [out PATH] [noqsearch]\n";
+        return 1;
+    }
+    std::ifstream file(settings.input);
+    if (!file) {
+        std::cerr << "cannot open " << settings.input << "\n";
+        return 1;
+    }
+
+    bitboard::init();
+    zobrist::init();
+    const int threads = settings.threads > 0 ? settings.threads
+                                             : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+        if (line.empty()) continue;
+        lines.push_back(std::move(line));
+        if (settings.limit && lines.size() == settings.limit) break;
+    }
+
+    // Positions are traced once; every epoch after that works on the terms.
+    std::vector<Dataset> slices(threads);
+    std::vector<std::size_t> skipped(threads);
+    parallel(threads, lines.size(), [&](std::size_t begin, std::size_t end, int t) {
+        slices[t] = load_slice(lines, begin, end, settings.qsearch, skipped[t]);
+    });
+    lines = {};
+    Dataset data;
+    std::size_t skippedTotal = 0;
+    for (int t = 0; t < threads; ++t) {
+        const auto offset = static_cast<uint32_t>(data.terms.size());
+        for (Sample s : slices[t].samples) {
+            s.begin += offset;
+            data.samples.push_back(s);
+        }
+        data.terms.insert(data.terms.end(), slices[t].terms.begin(), slices[t].terms.end());
+        slices[t] = {};
+        skippedTotal += skipped[t];
+    }
+    std::printf("traced %zu positions (%zu skipped), %zu terms, in %.1f s, %d threads\n", data.samples.size(),
+                skippedTotal, data.terms.size(), seconds_since(start), threads);
+    if (data.samples.empty()) return 1;
+
+    Weights w{};
+    {
+        int mg[WEIGHT_NB], eg[WEIGHT_NB];
+        eval::current_weights(mg, eg);
+        std::copy(mg, mg + WEIGHT_NB, w.mg);
+        std::copy(eg, eg + WEIGHT_NB, w.eg);
+    }
+    const double k = settings.k > 0.0 ? settings.k : fit_k(data, w, threads);
+    std::printf("K %.4f, error %.6f\n", k, mean_error(data, w, k, threads));
+    std::fflush(stdout);
+
+    const std::size_t batch = settings.batch ? std::min(settings.batch, data.samples.size()) : data.samples.size();
+    Adam adam;
+    Weights grad;
+    start = std::chrono::steady_clock::now();
+    for (int epoch = 1; epoch <= settings.epochs; ++epoch) {
+        for (std::size_t begin = 0; begin < data.samples.size(); begin += batch) {
+            gradient(data, begin, std::min(begin + batch, data.samples.size()), w, k, threads, grad);
+            adam.step(w, grad, settings.lr);
+        }
+        if (epoch % settings.report == 0 || epoch == settings.epochs) {
+            const double perEpoch = seconds_since(start) / epoch;
+            std::printf("epoch %d error %.6f (%.3f s/epoch)\n", epoch, mean_error(data, w, k, threads), perEpoch);
+            std::fflush(stdout);
+            if (!write_header(settings.out, w)) {
+                std::cerr << "cannot write " << settings.out << "\n";
+                return 1;
+            }
+        }
+    }
+    std::printf("wrote %s\n", settings.out.c_str());
+    return 0;
+}
+
+} // namespace phish::tools
\ No newline at end of file
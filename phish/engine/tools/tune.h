@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace phish::tools {
+
+// `phish_tune <file> [threads N] [epochs N] [lr X] [batch N] [k X] [limit N] [report N] [out PATH] [noqsearch]`:
+// Texel tuning of the classical evaluation weights against game results.
+//
+// Each line of the input holds a FEN and the result of the game it comes
+// from, from White's point of view: 1-0, 0-1 or 1/2-1/2 (bare or quoted,
+// as in EPD c9 fields), or a decimal such as [1.0], [0.5] or 0.0.
+// Positions are resolved by a quiescence search and the quiet position at
+// the end of its principal variation is traced into sparse coefficients
+// once; the weights are then fitted by Adam on the mean squared error
+// between the results and sigmoid(K * eval), over all positions per step
+// or over `batch` of them. K is fitted first unless given. The weights are
+// written to `out` (default weights.h) in the layout of
+// engine/eval/weights.h every `report` epochs and at the end. Returns the
+// process exit code.
+int tune(const std::vector<std::string>& args);
+
+} // namespace phish::tools
\ No newline at end of file
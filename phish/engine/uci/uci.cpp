@@ -1,21 +1,29 @@
 #include "engine/uci/uci.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "engine/util/config.h"
+#include "engine/bitbase/bitbase.h"
 #include "engine/bitboard/bitboard.h"
 #include "engine/board/position.h"
+#include "engine/eval/nnue/nnue.h"
 #include "engine/movegen/move.h"
 #include "engine/util/zobrist.h"
+#include "engine/search/params.h"
 #include "engine/search/search.h"
 
 namespace phish::uci {
@@ -35,6 +43,14 @@ std::vector<std::string> split_tokens(const std::string& line) {
     return tokens;
 }
 
+// Lines from the search thread and the input loop may interleave; each
+// call writes whole lines under one lock.
+void emit(const std::string& lines) {
+    static std::mutex mtx;
+    std::lock_guard<std::mutex> lock(mtx);
+    std::cout << lines << '\n' << std::flush;
+}
+
 void send_id() {
     std::cout << "id name Phish 0.1.0" << '\n';
     std::cout << "id author OpenAI" << '\n';
@@ -45,20 +61,82 @@ void send_options() {
     std::cout << "option name Hash type spin default 16 min 1 max 1048576" << '\n';
     std::cout << "option name Threads type spin default 1 min 1 max " << hw_threads << '\n';
     std::cout << "option name Ponder type check default false" << '\n';
-    std::cout << "option name SyzygyPath type string default " << '\n';
-    std::cout << "option name SyzygyProbeDepth type spin default 4 min 0 max 20" << '\n';
+    std::cout << "option name BitbasePath type string default " << '\n';
     std::cout << "option name UseNNUE type check default true" << '\n';
     std::cout << "option name EvalFile type string default phish.nnue" << '\n';
     std::cout << "option name Contempt type spin default 0 min -1000 max 1000" << '\n';
     std::cout << "option name MoveOverhead type spin default 30 min 0 max 1000" << '\n';
     std::cout << "option name MultiPV type spin default 1 min 1 max 256" << '\n';
+    std::cout << "option name Clear Hash type button" << '\n';
+
+    const search::SearchParams defaults;
+    std::size_t count = 0;
+    const search::ParamSpec* specs = search::param_specs(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::cout << "option name " << specs[i].name << " type spin default " << defaults.*specs[i].field
+                  << " min " << specs[i].min << " max " << specs[i].max << '\n';
+    }
 }
 
 struct PositionState {
     board::Position pos;
 };
 
-void handle_setoption(const std::string& line) {
+// What the network was last loaded from, so UseNNUE and EvalFile changes
+// take effect at the next isready, go or bench.
+struct NetworkState {
+    bool synced = false;
+    bool useNNUE = false;
+    std::string evalFile;
+};
+
+// Loads or drops the network after an option change. The callers run while
+// no search is active: setoption stops it, and go and bench sync first.
+// Scores and static evals in the TT and the eval cache come from the old
+// evaluation, so both are cleared when the network actually changes.
+void sync_network(NetworkState& ns, search::TranspositionTable& tt, search::SearchContext& context) {
+    if (ns.synced && ns.useNNUE == options().useNNUE && ns.evalFile == options().evalFile) return;
+    ns.synced = true;
+    ns.useNNUE = options().useNNUE;
+    ns.evalFile = options().evalFile;
+    const bool hadNetwork = eval::nnue::network() != nullptr;
+    if (!ns.useNNUE) {
+        eval::nnue::set_network(nullptr);
+        emit("info string classical evaluation");
+    } else {
+        std::string message;
+        auto net = eval::nnue::load_eval_file(ns.evalFile, message);
+        emit("info string " + message);
+        eval::nnue::set_network(std::move(net));
+    }
+    // Classical before and after (say, a file that failed to load) keeps them.
+    if (hadNetwork || eval::nnue::network()) {
+        tt.clear(options().threads);
+        context.clear();
+    }
+}
+
+// Directory the bitbases were last loaded from, synced at the same points
+// as the network.
+struct BitbaseState {
+    bool synced = false;
+    std::string path;
+};
+
+void sync_bitbases(BitbaseState& bs) {
+    if (bs.synced && bs.path == options().bitbasePath) return;
+    bs.synced = true;
+    bs.path = options().bitbasePath;
+    if (bs.path.empty()) {
+        bitbase::clear();
+        return;
+    }
+    std::string message;
+    bitbase::load(bs.path, message);
+    emit("info string " + message);
+}
+
+void handle_setoption(const std::string& line, search::TranspositionTable& tt) {
     const auto name_pos = line.find("name ");
     if (name_pos == std::string::npos) return;
     const auto value_pos = line.find(" value ", name_pos);
@@ -81,7 +159,22 @@ void handle_setoption(const std::string& line) {
     trim(name);
     trim(value);
 
+    const std::string lname = to_lower(name);
+    if (lname == "clear hash") {
+        tt.clear(options().threads);
+        return;
+    }
+
+    if (search::set_param(name, value)) return;
     set_option(name, value);
+
+    // Only a Hash change needs a new table; other options must not stall on
+    // reallocating and clearing it.
+    if (lname == "hash" && !tt.resize(static_cast<std::size_t>(options().hashMb), options().threads)) {
+        emit("info string cannot allocate " + std::to_string(options().hashMb) + " MB for the hash table, keeping " +
+             std::to_string(tt.size_mb()) + " MB");
+        options().hashMb = static_cast<int>(tt.size_mb());
+    }
 }
 
 void handle_position(const std::vector<std::string>& tokens, PositionState& st) {
@@ -142,29 +235,193 @@ std::string move_to_uci(movegen::Move m) {
     return std::string(buf);
 }
 
-void handle_go(const std::vector<std::string>& tokens, PositionState& st, search::TranspositionTable& tt) {
-    // Parse depth and simple movetime/wtime/btime for MVP
-    int depth = 1;
-    int64_t movetime = 0;
+// "cp <x>" or "mate <moves>" (negative when we are getting mated).
+std::string format_score(int score) {
+    if (std::abs(score) >= search::VALUE_MATE_IN_MAX_PLY) {
+        const int moves = score > 0 ? (search::VALUE_MATE - score + 1) / 2 : -(search::VALUE_MATE + score) / 2;
+        return "mate " + std::to_string(moves);
+    }
+    return "cp " + std::to_string(score);
+}
+
+std::string format_info(const search::SearchInfo& info) {
+    std::ostringstream out;
+    out << "info depth " << info.depth << " seldepth " << info.selDepth << " multipv " << info.multiPv << " score "
+        << format_score(info.score);
+    if (info.lowerBound) out << " lowerbound";
+    else if (info.upperBound) out << " upperbound";
+    out << " nodes " << info.nodes << " nps " << info.nodes * 1000 / static_cast<uint64_t>(std::max<int64_t>(info.timeMs, 1))
+        << " hashfull " << info.hashfull << " tbhits " << info.tbHits << " time " << info.timeMs << " pv";
+    for (auto m : info.pv) out << ' ' << move_to_uci(m);
+    return out.str();
+}
+
+search::Limits parse_go(const std::vector<std::string>& tokens, const PositionState& st) {
     int64_t wtime = 0, btime = 0, winc = 0, binc = 0;
+    search::Limits lim;
     for (std::size_t i = 1; i < tokens.size(); ++i) {
-        if (tokens[i] == "depth" && i + 1 < tokens.size()) depth = std::atoi(tokens[i + 1].c_str());
-        if (tokens[i] == "movetime" && i + 1 < tokens.size()) movetime = std::atoll(tokens[i + 1].c_str());
-        if (tokens[i] == "wtime" && i + 1 < tokens.size()) wtime = std::atoll(tokens[i + 1].c_str());
-        if (tokens[i] == "btime" && i + 1 < tokens.size()) btime = std::atoll(tokens[i + 1].c_str());
-        if (tokens[i] == "winc" && i + 1 < tokens.size()) winc = std::atoll(tokens[i + 1].c_str());
-        if (tokens[i] == "binc" && i + 1 < tokens.size()) binc = std::atoll(tokens[i + 1].c_str());
+        const bool hasValue = i + 1 < tokens.size();
+        if (tokens[i] == "infinite") lim.infinite = true;
+        if (!hasValue) continue;
+        if (tokens[i] == "depth") lim.depth = std::max(0, std::atoi(tokens[i + 1].c_str()));
+        if (tokens[i] == "movetime") lim.moveTimeMs = std::atoll(tokens[i + 1].c_str());
+        if (tokens[i] == "movestogo") lim.movesToGo = std::atoi(tokens[i + 1].c_str());
+        if (tokens[i] == "mate") lim.mate = std::max(0, std::atoi(tokens[i + 1].c_str()));
+        if (tokens[i] == "nodes") lim.nodes = std::strtoull(tokens[i + 1].c_str(), nullptr, 10);
+        if (tokens[i] == "wtime") wtime = std::atoll(tokens[i + 1].c_str());
+        if (tokens[i] == "btime") btime = std::atoll(tokens[i + 1].c_str());
+        if (tokens[i] == "winc") winc = std::atoll(tokens[i + 1].c_str());
+        if (tokens[i] == "binc") binc = std::atoll(tokens[i + 1].c_str());
+    }
+    const bool white = st.pos.side_to_move() == WHITE;
+    lim.timeMs = white ? wtime : btime;
+    lim.incMs = white ? winc : binc;
+    lim.multiPv = options().multiPV;
+    return lim;
+}
+
+// Runs one search at a time on a worker thread so the input loop keeps
+// reading commands. The worker owns the final output: it prints bestmove
+// exactly once per go, after the search ends on its own limits, on stop()
+// or, for a ponder search, no earlier than ponderhit().
+class SearchThread {
+public:
+    ~SearchThread() {
+        stop();
+        wait();
     }
-    search::Limits lim; lim.depth = depth;
-    if (movetime > 0) { lim.timeMs = movetime; }
-    else {
-        bool white = st.pos.side_to_move() == WHITE;
-        lim.timeMs = white ? wtime : btime;
-        lim.incMs = white ? winc : binc;
+
+    void start(const board::Position& pos, search::Limits limits, bool ponder, search::SearchContext& context) {
+        wait();
+        stopFlag.store(false);
+        ponderFlag.store(ponder);
+        limits.stop = &stopFlag;
+        limits.ponder = &ponderFlag;
+        limits.onInfo = [](const search::SearchInfo& info) { emit(format_info(info)); };
+        limits.onCurrMove = [](int depth, movegen::Move m, int number) {
+            emit("info depth " + std::to_string(depth) + " currmove " + move_to_uci(m) + " currmovenumber " +
+                 std::to_string(number));
+        };
+        worker = std::thread([this, root = pos, limits, &context]() mutable {
+            const auto res = context.think(root, limits, options().moveOverheadMs);
+            // UCI forbids bestmove before stop during an infinite search, or
+            // before ponderhit/stop while pondering, even if the search itself
+            // has nothing left to do.
+            {
+                std::unique_lock<std::mutex> lock(releaseMutex);
+                released.wait(lock, [&] { return stopFlag.load() || (!limits.infinite && !ponderFlag.load()); });
+            }
+            std::ostringstream out;
+            out << "info string nodes " << res.nodes << " qnodes " << res.qnodes << " tthits " << res.ttHits << "/"
+                << res.ttProbes << " depth " << res.depth << " time " << res.timeMs << '\n';
+            if (res.noMate) out << "info string no mate in " << limits.mate << " found\n";
+            out << "bestmove " << (res.bestMove ? move_to_uci(res.bestMove) : std::string("0000"));
+            if (res.pv.size() >= 2) out << " ponder " << move_to_uci(res.pv[1]);
+            emit(out.str());
+        });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(releaseMutex);
+            stopFlag.store(true);
+        }
+        released.notify_all();
+    }
+
+    // The opponent played the expected move: keep searching, now on our clock.
+    void ponderhit() {
+        {
+            std::lock_guard<std::mutex> lock(releaseMutex);
+            ponderFlag.store(false);
+        }
+        released.notify_all();
+    }
+
+    void wait() {
+        if (worker.joinable()) worker.join();
     }
-    auto res = search::think(st.pos, lim, tt);
-    std::cout << "info string nodes " << res.nodes << '\n';
-    std::cout << "bestmove " << move_to_uci(res.bestMove) << '\n' << std::flush;
+
+private:
+    std::thread worker;
+    std::atomic<bool> stopFlag{false};
+    std::atomic<bool> ponderFlag{false};
+    std::mutex releaseMutex;
+    std::condition_variable released;
+};
+
+const char* const BENCH_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r2q1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 9",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+// Known endings: each is either decided by material and king placement or
+// a textbook draw, so the search should settle them with little effort.
+const char* const BENCH_ENDGAME_FENS[] = {
+    "8/8/8/4k3/8/8/8/KBN5 w - - 0 1",
+    "8/8/8/3k4/8/8/8/KQ6 w - - 0 1",
+    "8/8/3k4/8/8/3r4/8/KQ6 w - - 0 1",
+    "8/8/4k3/4b3/8/8/8/K2R4 w - - 0 1",
+    "8/8/3k4/3n4/8/8/8/K5R1 w - - 0 1",
+    "8/8/8/3k4/8/8/8/KNN5 w - - 0 1",
+    "k7/8/8/8/P7/8/8/7K w - - 0 1",
+    "7k/8/8/8/7P/8/8/1B4K1 w - - 0 1",
+    "8/5k2/2b2p2/5P2/4P3/8/3BK3/8 w - - 0 1",
+    "8/8/8/4k3/8/8/4P3/4K3 w - - 0 1",
+};
+
+// Fixed-depth search over BENCH_FENS, or BENCH_ENDGAME_FENS with
+// "endgames", with a cleared TT per position. Reports totals for comparing
+// node counts, time-to-depth and TT efficiency.
+void handle_bench(const std::vector<std::string>& tokens, search::TranspositionTable& tt,
+                  search::SearchContext& context) {
+    int depth = 5;
+    if (tokens.size() >= 2) depth = std::max(1, std::atoi(tokens[1].c_str()));
+    std::span<const char* const> fens = BENCH_FENS;
+    if (tokens.size() >= 3 && tokens[2] == "endgames") fens = BENCH_ENDGAME_FENS;
+
+    std::uint64_t nodes = 0, qnodes = 0, evals = 0, probes = 0, hits = 0, pawnProbes = 0, pawnHits = 0, failHigh = 0, failHighFirst = 0;
+    std::int64_t ms = 0;
+    int aspirationFails = 0;
+    for (const char* fen : fens) {
+        board::Position pos;
+        pos.set_fen(fen);
+        tt.clear(options().threads);
+        context.clear();
+        search::Limits lim;
+        lim.depth = depth;
+        lim.multiPv = options().multiPV;
+        // Time the search only; clearing a large table would dominate otherwise.
+        const auto start = std::chrono::steady_clock::now();
+        const auto res = context.think(pos, lim);
+        ms += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        nodes += res.nodes;
+        qnodes += res.qnodes;
+        evals += res.evalCalls;
+        probes += res.ttProbes;
+        hits += res.ttHits;
+        pawnProbes += res.pawnProbes;
+        pawnHits += res.pawnHits;
+        failHigh += res.failHigh;
+        failHighFirst += res.failHighFirst;
+        aspirationFails += res.aspirationFails;
+    }
+
+    std::cout << "info string bench depth " << depth << " positions " << fens.size() << '\n';
+    std::cout << "info string bench nodes " << nodes << " time " << ms
+              << " nps " << (nodes * 1000 / static_cast<std::uint64_t>(std::max<std::int64_t>(ms, 1)))
+              << " qnodes " << (nodes ? qnodes * 1000 / nodes : 0) << "/1000"
+              << " evals " << (nodes ? evals * 1000 / nodes : 0) << "/1000"
+              << " tthits " << (probes ? hits * 1000 / probes : 0) << "/1000"
+              << " pawnhits " << (pawnProbes ? pawnHits * 1000 / pawnProbes : 0) << "/1000"
+              << " fhfirst " << (failHigh ? failHighFirst * 1000 / failHigh : 0) << "/1000"
+              << " aspfails " << aspirationFails << '\n' << std::flush;
 }
 
 void handle_perft(const std::vector<std::string>& tokens, PositionState& st) {
@@ -182,6 +439,10 @@ void run() {
     PositionState state;
     state.pos.set_fen("startpos");
     search::TranspositionTable tt(static_cast<std::size_t>(options().hashMb));
+    search::SearchContext context(tt);
+    SearchThread searcher;
+    NetworkState network;
+    BitbaseState bitbases;
 
     std::string line;
     while (std::getline(std::cin, line)) {
@@ -191,39 +452,58 @@ void run() {
 
         const std::string cmd = tokens[0];
 
+        // Commands that touch the position, TT or search state are not
+        // expected mid-search; finish the running search first rather
+        // than race with it.
+        if (cmd == "setoption" || cmd == "ucinewgame" || cmd == "position" || cmd == "go" || cmd == "bench" ||
+            cmd == "perft") {
+            searcher.stop();
+            searcher.wait();
+        }
+
         if (cmd == "uci") {
             send_id();
             send_options();
             std::cout << "uciok" << '\n' << std::flush;
         } else if (cmd == "isready") {
-            std::cout << "readyok" << '\n' << std::flush;
+            sync_network(network, tt, context);
+            sync_bitbases(bitbases);
+            emit("readyok");
         } else if (cmd == "setoption") {
-            handle_setoption(line);
-            // Resize TT if hash changed
-            tt.resize(static_cast<std::size_t>(options().hashMb));
+            handle_setoption(line, tt);
         } else if (cmd == "ucinewgame") {
             state.pos.set_fen("startpos");
-            tt.clear();
+            tt.clear(options().threads);
+            context.clear();
         } else if (cmd == "position") {
             handle_position(tokens, state);
         } else if (cmd == "go") {
-            handle_go(tokens, state, tt);
+            sync_network(network, tt, context);
+            sync_bitbases(bitbases);
+            const bool ponder = std::find(tokens.begin(), tokens.end(), "ponder") != tokens.end();
+            searcher.start(state.pos, parse_go(tokens, state), ponder, context);
         } else if (cmd == "stop") {
-            std::cout << "bestmove 0000" << '\n' << std::flush;
+            searcher.stop();
         } else if (cmd == "bench") {
-            std::cout << "info string bench not implemented" << '\n';
-            std::cout << "bestmove 0000" << '\n' << std::flush;
+            sync_network(network, tt, context);
+            sync_bitbases(bitbases);
+            handle_bench(tokens, tt, context);
         } else if (cmd == "perft") {
             handle_perft(tokens, state);
         } else if (cmd == "quit") {
             break;
         } else if (cmd == "ponderhit") {
+            searcher.ponderhit();
         } else if (cmd == "eval" || cmd == "d") {
-            std::cout << "info string debug print not implemented" << '\n' << std::flush;
+            emit("info string debug print not implemented");
         } else if (cmd == "help") {
-            std::cout << "info string commands: uci, isready, setoption, ucinewgame, position, go, stop, perft, bench, quit" << '\n' << std::flush;
+            emit("info string commands: uci, isready, setoption, ucinewgame, position, go, stop, perft, bench, quit");
         }
     }
+    // Stop and join before the TT goes out of scope; the search still
+    // reports its bestmove.
+    searcher.stop();
+    searcher.wait();
 }
 
 } // namespace phish::uci
\ No newline at end of file
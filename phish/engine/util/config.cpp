@@ -39,11 +39,8 @@ void set_option(const std::string& name, const std::string& value) {
         if (v > 0) g_options.threads = static_cast<int>(v);
     } else if (iequals(lname, "ponder")) {
         g_options.ponder = iequals(value, "true") || iequals(value, "1") || iequals(value, "on");
-    } else if (iequals(lname, "syzygypath")) {
-        g_options.syzygyPath = value;
-    } else if (iequals(lname, "syzygyprobedepth")) {
-        const long v = std::strtol(value.c_str(), nullptr, 10);
-        if (v >= 0) g_options.syzygyProbeDepth = static_cast<int>(v);
+    } else if (iequals(lname, "bitbasepath")) {
+        g_options.bitbasePath = value;
     } else if (iequals(lname, "usennue")) {
         g_options.useNNUE = iequals(value, "true") || iequals(value, "1") || iequals(value, "on");
     } else if (iequals(lname, "evalfile")) {
@@ -8,8 +8,7 @@ struct Options {
     int threads = 1;
     int hashMb = 16;
     bool ponder = false;
-    std::string syzygyPath;
-    int syzygyProbeDepth = 4;
+    std::string bitbasePath; // directory of *.pbb files, empty for none
     bool useNNUE = true;
     std::string evalFile = "phish.nnue";
     int contempt = 0; // in centipawns
@@ -0,0 +1,137 @@
+#include "engine/util/memory.h"
+
+#include <cstdlib>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PHISH_MMAP_FILES 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace phish::memory {
+
+namespace {
+
+constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+constexpr std::size_t PAGE_SIZE = 4096;
+
+std::size_t round_up(std::size_t v, std::size_t align) { return (v + align - 1) / align * align; }
+
+} // namespace
+
+LargeBlock allocate_large(std::size_t bytes) {
+    LargeBlock block;
+    if (bytes == 0) return block;
+
+#if defined(__linux__) && defined(MAP_HUGETLB)
+    {
+        const std::size_t size = round_up(bytes, HUGE_PAGE_SIZE);
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            block.ptr = p;
+            block.bytes = size;
+            block.kind = PageKind::HugeTLB;
+            return block;
+        }
+    }
+#endif
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    {
+        const std::size_t size = round_up(bytes, HUGE_PAGE_SIZE);
+        if (void* p = std::aligned_alloc(HUGE_PAGE_SIZE, size)) {
+            madvise(p, size, MADV_HUGEPAGE);
+            block.ptr = p;
+            block.bytes = size;
+            block.kind = PageKind::Transparent;
+            return block;
+        }
+    }
+#endif
+
+    const std::size_t size = round_up(bytes, PAGE_SIZE);
+    if (void* p = std::aligned_alloc(PAGE_SIZE, size)) {
+        block.ptr = p;
+        block.bytes = size;
+        block.kind = PageKind::Regular;
+    }
+    return block;
+}
+
+void free_large(LargeBlock& block) {
+    if (!block.ptr) return;
+#if defined(__linux__)
+    if (block.kind == PageKind::HugeTLB) munmap(block.ptr, block.bytes);
+    else std::free(block.ptr);
+#else
+    std::free(block.ptr);
+#endif
+    block = LargeBlock{};
+}
+
+bool MappedFile::open(const std::string& path, std::string& error) {
+    close();
+#ifdef PHISH_MMAP_FILES
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            base = static_cast<const unsigned char*>(p);
+            bytes = static_cast<std::size_t>(st.st_size);
+            isMapped = true;
+        }
+    }
+    ::close(fd);
+    if (isMapped) return true;
+#endif
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const auto size = static_cast<std::size_t>(in.tellg());
+    block = allocate_large(size);
+    if (!block.ptr) {
+        error = "out of memory";
+        return false;
+    }
+    in.seekg(0);
+    in.read(static_cast<char*>(block.ptr), static_cast<std::streamsize>(size));
+    if (static_cast<std::size_t>(in.gcount()) != size) {
+        error = "cannot read " + path;
+        free_large(block);
+        return false;
+    }
+    base = static_cast<const unsigned char*>(block.ptr);
+    bytes = size;
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef PHISH_MMAP_FILES
+    if (isMapped) munmap(const_cast<unsigned char*>(base), bytes);
+#endif
+    free_large(block);
+    base = nullptr;
+    bytes = 0;
+    isMapped = false;
+}
+
+const char* page_kind_name(PageKind kind) {
+    switch (kind) {
+        case PageKind::HugeTLB: return "hugetlb";
+        case PageKind::Transparent: return "thp";
+        case PageKind::Regular: return "regular";
+        default: return "none";
+    }
+}
+
+} // namespace phish::memory
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace phish::memory {
+
+enum class PageKind { None, HugeTLB, Transparent, Regular };
+
+// Large, page-aligned allocation for big tables such as the TT. Pages are
+// not touched here, so the first writer decides their NUMA placement.
+struct LargeBlock {
+    void* ptr = nullptr;
+    std::size_t bytes = 0;
+    PageKind kind = PageKind::None;
+};
+
+// Tries explicit huge pages (MAP_HUGETLB), then a 2 MB aligned block advised
+// for transparent huge pages, then a plain aligned block. Returns an empty
+// block on failure.
+LargeBlock allocate_large(std::size_t bytes);
+void free_large(LargeBlock& block);
+
+const char* page_kind_name(PageKind kind);
+
+// Read-only bytes of a file: mapped where the platform can, so processes
+// share one copy in the page cache, and read into a LargeBlock otherwise.
+// Owns the mapping or the block until close() or destruction.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Replaces any open file. False with the reason in `error` when the
+    // file cannot be opened or read in full.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    const unsigned char* data() const { return base; }
+    std::size_t size() const { return bytes; }
+    bool mapped() const { return isMapped; }
+
+private:
+    const unsigned char* base = nullptr;
+    std::size_t bytes = 0;
+    bool isMapped = false;
+    LargeBlock block;
+};
+
+} // namespace phish::memory
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace phish {
+
+// Runs fn(begin, end, thread) on `threads` threads, each over its own
+// contiguous slice of [0, count). The calling thread takes slice 0.
+template <typename Fn>
+void parallel(int threads, std::size_t count, Fn&& fn) {
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back([&fn, t, threads, count] { fn(count * t / threads, count * (t + 1) / threads, t); });
+    fn(0, count / threads, 0);
+    for (std::thread& th : pool) th.join();
+}
+
+} // namespace phish
\ No newline at end of file
@@ -49,6 +49,12 @@ enum Square : int {
     SQ_NONE = 64
 };
 
+inline Piece make_piece(Color c, PieceType pt) {
+    return static_cast<Piece>(static_cast<int>(c) * 6 + static_cast<int>(pt));
+}
+inline Color piece_color(Piece pc) { return static_cast<Color>(static_cast<int>(pc) / 6); }
+inline PieceType piece_type(Piece pc) { return static_cast<PieceType>(static_cast<int>(pc) % 6); }
+
 inline int file_of(Square s) { return static_cast<int>(s) & 7; }
 inline int rank_of(Square s) { return static_cast<int>(s) >> 3; }
 
@@ -1,6 +1,15 @@
+#include <string>
+#include <vector>
+
+#include "engine/tools/bitbases.h"
+#include "engine/tools/evalbatch.h"
 #include "engine/uci/uci.h"
 
-int main() {
+int main(int argc, char** argv) {
+    if (argc >= 2 && std::string(argv[1]) == "evalbatch")
+        return phish::tools::evalbatch(std::vector<std::string>(argv + 2, argv + argc));
+    if (argc >= 2 && std::string(argv[1]) == "bitbases")
+        return phish::tools::bitbases(std::vector<std::string>(argv + 2, argv + argc));
     phish::uci::run();
     return 0;
 }
\ No newline at end of file
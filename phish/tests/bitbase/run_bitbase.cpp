@@ -0,0 +1,398 @@
+// Generates bitbases into a scratch directory and checks them with the
+// engine's own move generator, which the generator does not use:
+//   - every position of each 3-man table, and a sample of each larger one,
+//     must score the best of its moves' results as probed one ply on, with
+//     mates and stalemates at the leaves; the colour-mirrored position must
+//     probe the same,
+//   - the 3-man tables must equal a forward solve over the same positions,
+//     and sampled positions of every table must fall within the bounds of
+//     a depth-limited minimax that never probes,
+//   - a few known positions must score as expected, and a search from a
+//     won one must keep the win.
+// Finishes with probes/s on legal positions.
+//
+// Usage: phish_bitbase [dir] [materials...]   (default KPvK KRvKN)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "engine/bitbase/bitbase.h"
+#include "engine/bitbase/generate.h"
+#include "engine/bitboard/bitboard.h"
+#include "engine/util/zobrist.h"
+#include "engine/board/position.h"
+#include "engine/search/search.h"
+
+namespace {
+
+using namespace phish;
+using bitbase::Wdl;
+
+constexpr uint64_t SAMPLES = 200000;
+constexpr int MINIMAX_SAMPLES = 400;
+constexpr int MINIMAX_DEPTH = 3;
+
+int failures = 0;
+
+const char* wdl_name(Wdl w) { return w == Wdl::Win ? "win" : w == Wdl::Loss ? "loss" : "draw"; }
+
+bool build(const bitbase::Material& m, const std::string& dir) {
+    if (bitbase::loaded(m)) return true;
+    for (const bitbase::Material& next : bitbase::successors(m))
+        if (!build(next, dir)) return false;
+    const std::string path = (std::filesystem::path(dir) / (m.name() + ".pbb")).string();
+    bitbase::GenerateStats stats;
+    std::string error;
+    if (!bitbase::generate(m, path, 0, stats, error) || !bitbase::load_file(path, error)) {
+        std::cerr << m.name() << ": " << error << "\n";
+        return false;
+    }
+    std::cout << m.name() << ": " << stats.positions << " positions, " << stats.wins << " wins, " << stats.draws
+              << " draws, " << stats.losses << " losses, " << stats.passes << " passes, " << stats.seconds
+              << " s, " << std::filesystem::file_size(path) << " bytes\n";
+    return true;
+}
+
+// Sets `pos` to the men given; false unless the side not to move is safe.
+bool set_position(board::Position& pos, const bitbase::Indexer& ix, const Square* squares, Color stm, bool mirror) {
+    board::PackedPosition packed;
+    U64 occupied = 0;
+    Piece on[64];
+    for (int s = 0; s < ix.men(); ++s) {
+        const Square sq = mirror ? static_cast<Square>(squares[s] ^ 56) : squares[s];
+        const Piece pc = ix.piece(s);
+        on[sq] = mirror ? static_cast<Piece>(pc < 6 ? pc + 6 : pc - 6) : pc;
+        occupied |= Bit(sq);
+    }
+    int n = 0;
+    for (int i = 0; i < 8; ++i) packed.bytes[i] = static_cast<unsigned char>(occupied >> (8 * i));
+    for (U64 b = occupied; b; b &= b - 1, ++n)
+        packed.bytes[8 + n / 2] |= static_cast<unsigned char>(on[__builtin_ctzll(b)] << (4 * (n % 2)));
+    const Color side = mirror ? opposite(stm) : stm;
+    packed.bytes[24] = side == BLACK ? 1 : 0;
+    packed.bytes[25] = SQ_NONE;
+    packed.bytes[28] = 1;
+    if (!pos.set_packed(packed)) return false;
+    const Square theirKing = static_cast<Square>(__builtin_ctzll(pos.pieces(side == WHITE ? B_KING : W_KING)));
+    return !(pos.attackers_to(theirKing, occupied) & pos.color_bb(side));
+}
+
+// Best result of the moves, each probed after it is made.
+bool one_ply(board::Position& pos, Wdl& best) {
+    movegen::MoveList moves;
+    pos.generate_legal(moves);
+    if (moves.size() == 0) {
+        best = pos.in_check() ? Wdl::Loss : Wdl::Draw;
+        return true;
+    }
+    best = Wdl::Loss;
+    board::StateInfo st;
+    for (const movegen::Move m : moves) {
+        Wdl child;
+        pos.make_move(m, st);
+        const bool found = bitbase::probe(pos, child);
+        pos.unmake_move(m, st);
+        if (!found) return false;
+        best = std::max(best, static_cast<Wdl>(-static_cast<int>(child)));
+    }
+    return true;
+}
+
+// No mate is possible with bare kings or a single minor piece.
+bool insufficient(const board::Position& pos) {
+    const int men = __builtin_popcountll(pos.color_bb(WHITE) | pos.color_bb(BLACK));
+    const U64 minors = pos.pieces(W_KNIGHT) | pos.pieces(B_KNIGHT) | pos.pieces(W_BISHOP) | pos.pieces(B_BISHOP);
+    return men == 2 || (men == 3 && minors);
+}
+
+// Bounds [lo, hi] on the result (-1 loss, 0 draw, 1 win) from a full-width
+// search of `depth` plies that never probes.
+void minimax(board::Position& pos, int depth, int& lo, int& hi) {
+    movegen::MoveList moves;
+    pos.generate_legal(moves);
+    if (moves.size() == 0) {
+        lo = hi = pos.in_check() ? -1 : 0;
+        return;
+    }
+    if (insufficient(pos)) {
+        lo = hi = 0;
+        return;
+    }
+    if (depth == 0) {
+        lo = -1;
+        hi = 1;
+        return;
+    }
+    lo = hi = -1;
+    board::StateInfo st;
+    for (const movegen::Move m : moves) {
+        int childLo, childHi;
+        pos.make_move(m, st);
+        minimax(pos, depth - 1, childLo, childHi);
+        pos.unmake_move(m, st);
+        lo = std::max(lo, -childHi);
+        hi = std::max(hi, -childLo);
+        if (lo == 1) return;
+    }
+}
+
+void check_table(const bitbase::Material& m, std::mt19937_64& rng) {
+    const bitbase::Indexer ix(m);
+    const bool exhaustive = ix.size() * 2 <= SAMPLES;
+    uint64_t checked = 0, proven = 0, sampled = 0, mismatches = 0;
+    board::Position pos, mirrored;
+    Square squares[bitbase::MAX_MEN];
+    const auto visit = [&](Color stm, uint64_t idx) {
+        if (!ix.decode(idx, squares) || ix.index(squares) != idx) return;
+        if (!set_position(pos, ix, squares, stm, false) || !set_position(mirrored, ix, squares, stm, true)) return;
+        Wdl stored, flipped, expected;
+        if (!bitbase::probe(pos, stored) || !bitbase::probe(mirrored, flipped) || !one_ply(pos, expected)) {
+            if (++mismatches <= 5) std::cerr << m.name() << " " << idx << ": probe failed\n";
+            return;
+        }
+        ++checked;
+        if (stored != expected || stored != flipped) {
+            if (++mismatches <= 5)
+                std::cerr << m.name() << " " << (stm == WHITE ? "w" : "b") << " " << idx << ": stored "
+                          << wdl_name(stored) << ", mirrored " << wdl_name(flipped) << ", moves give "
+                          << wdl_name(expected) << "\n";
+            return;
+        }
+        if (sampled >= MINIMAX_SAMPLES || rng() % 8) return;
+        ++sampled;
+        int lo, hi;
+        minimax(pos, MINIMAX_DEPTH, lo, hi);
+        proven += lo == hi;
+        if (static_cast<int>(stored) < lo || static_cast<int>(stored) > hi) {
+            if (++mismatches <= 5)
+                std::cerr << m.name() << " " << idx << ": stored " << wdl_name(stored) << " outside minimax ["
+                          << lo << ", " << hi << "]\n";
+        }
+    };
+    for (Color stm : {WHITE, BLACK}) {
+        if (exhaustive)
+            for (uint64_t idx = 0; idx < ix.size(); ++idx) visit(stm, idx);
+        else
+            for (uint64_t k = 0; k < SAMPLES / 2; ++k) visit(stm, rng() % ix.size());
+    }
+    std::cout << m.name() << ": " << checked << (exhaustive ? " positions (all)" : " positions (sampled)")
+              << " consistent, " << sampled << " minimax samples (" << proven << " proven), " << mismatches
+              << " mismatches\n";
+    failures += static_cast<int>(mismatches);
+}
+
+// Squares of `pos` in the table's slot order.
+void slot_squares(const board::Position& pos, const bitbase::Indexer& ix, Square* squares) {
+    U64 taken = 0;
+    for (int s = 0; s < ix.men(); ++s) {
+        const U64 left = pos.pieces(ix.piece(s)) & ~taken;
+        squares[s] = static_cast<Square>(__builtin_ctzll(left));
+        taken |= Bit(squares[s]);
+    }
+}
+
+// Solves the table again by forward value iteration over the engine's move
+// generator: a position wins once a move reaches a loss and loses once
+// every move reaches a win; what never settles is a draw. Moves that change
+// the material are probed in the other tables.
+void forward_solve(const bitbase::Material& m) {
+    enum : uint8_t { UNKNOWN, WIN, LOSS, DRAW, INVALID };
+    const bitbase::Indexer ix(m);
+    const uint64_t size = ix.size();
+    std::vector<uint8_t> value(2 * size, INVALID);
+    std::vector<uint8_t> drawExit(2 * size, 0);
+    std::vector<uint32_t> first(2 * size + 1, 0);
+    std::vector<uint32_t> children;
+    board::Position pos;
+    Square squares[bitbase::MAX_MEN];
+    for (uint64_t c = 0; c < 2 * size; ++c) {
+        first[c] = static_cast<uint32_t>(children.size());
+        const Color stm = c < size ? WHITE : BLACK;
+        if (!ix.decode(c % size, squares) || ix.index(squares) != c % size ||
+            !set_position(pos, ix, squares, stm, false))
+            continue;
+        value[c] = UNKNOWN;
+        movegen::MoveList moves;
+        pos.generate_legal(moves);
+        if (moves.size() == 0) value[c] = pos.in_check() ? LOSS : DRAW;
+        const U64 material = pos.material_key();
+        board::StateInfo st;
+        for (const movegen::Move mv : moves) {
+            pos.make_move(mv, st);
+            if (pos.material_key() == material) {
+                slot_squares(pos, ix, squares);
+                children.push_back(static_cast<uint32_t>((c < size ? size : 0) + ix.index(squares)));
+            } else {
+                Wdl wdl = Wdl::Draw;
+                bitbase::probe(pos, wdl);
+                if (wdl == Wdl::Loss) value[c] = WIN;
+                if (wdl == Wdl::Draw) drawExit[c] = 1;
+            }
+            pos.unmake_move(mv, st);
+        }
+    }
+    first[2 * size] = static_cast<uint32_t>(children.size());
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint64_t c = 0; c < 2 * size; ++c) {
+            if (value[c] != UNKNOWN) continue;
+            bool allWin = !drawExit[c];
+            for (uint32_t k = first[c]; k < first[c + 1]; ++k) {
+                if (value[children[k]] == LOSS) {
+                    value[c] = WIN;
+                    break;
+                }
+                allWin &= value[children[k]] == WIN;
+            }
+            if (value[c] == UNKNOWN && allWin) value[c] = LOSS;
+            changed |= value[c] != UNKNOWN;
+        }
+    }
+
+    uint64_t compared = 0, mismatches = 0;
+    for (uint64_t c = 0; c < 2 * size; ++c) {
+        if (value[c] == INVALID) continue;
+        const Color stm = c < size ? WHITE : BLACK;
+        ix.decode(c % size, squares);
+        set_position(pos, ix, squares, stm, false);
+        const Wdl expected = value[c] == WIN ? Wdl::Win : value[c] == LOSS ? Wdl::Loss : Wdl::Draw;
+        Wdl stored = Wdl::Draw;
+        bitbase::probe(pos, stored);
+        ++compared;
+        if (stored != expected && ++mismatches <= 5)
+            std::cerr << m.name() << " " << c << ": stored " << wdl_name(stored) << ", forward solve "
+                      << wdl_name(expected) << "\n";
+    }
+    std::cout << m.name() << ": " << compared << " positions match the forward solve, " << mismatches
+              << " mismatches\n";
+    failures += static_cast<int>(mismatches);
+}
+
+struct Known {
+    const char* fen;
+    Wdl wdl;
+};
+
+const Known KNOWN[] = {
+    {"4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", Wdl::Win},
+    {"4k3/8/4K3/4P3/8/8/8/8 b - - 0 1", Wdl::Loss},
+    {"8/8/8/8/8/k7/P7/K7 w - - 0 1", Wdl::Draw},
+    {"k7/p7/K7/8/8/8/8/8 b - - 0 1", Wdl::Draw},
+    {"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", Wdl::Draw},
+    {"7k/6Q1/6K1/8/8/8/8/8 b - - 0 1", Wdl::Loss},
+    {"8/8/8/4k3/8/8/8/4K2R w - - 0 1", Wdl::Win},
+    {"8/8/8/4k3/8/8/8/R3K3 w Q - 0 1", Wdl::Draw}, // castling rights: no probe
+    {"8/8/4k3/8/8/8/8/4KN2 w - - 0 1", Wdl::Draw},
+};
+
+void check_known() {
+    board::Position pos;
+    for (const Known& k : KNOWN) {
+        pos.set_fen(k.fen);
+        Wdl wdl = Wdl::Draw;
+        const bool found = bitbase::probe(pos, wdl);
+        const bool expectProbe = pos.castling_rights() == 0;
+        if (found != expectProbe || (found && wdl != k.wdl)) {
+            std::cerr << k.fen << ": " << (found ? wdl_name(wdl) : "no probe") << ", expected " << wdl_name(k.wdl)
+                      << "\n";
+            ++failures;
+        }
+    }
+
+    // One move of nine keeps the win; the root filter leaves only it.
+    search::TranspositionTable tt(16);
+    search::SearchContext context(tt);
+    search::Limits limits;
+    limits.depth = 8;
+    pos.set_fen("8/8/8/4k3/8/8/3PK3/8 w - - 0 1");
+    Wdl root = Wdl::Draw;
+    bitbase::probe(pos, root);
+    const search::SearchResult result = context.think(pos, limits);
+    board::StateInfo st;
+    Wdl after = Wdl::Draw;
+    pos.make_move(result.bestMove, st);
+    bitbase::probe(pos, after);
+    if (root != Wdl::Win || after != Wdl::Loss || result.tbHits == 0) {
+        std::cerr << "search kept " << wdl_name(static_cast<Wdl>(-static_cast<int>(after))) << " of "
+                  << wdl_name(root) << " with " << result.tbHits << " tbhits\n";
+        ++failures;
+    }
+    std::cout << "known positions and root filter checked, " << result.tbHits << " tbhits\n";
+}
+
+void bench_probes(const bitbase::Material& m, std::mt19937_64& rng) {
+    const bitbase::Indexer ix(m);
+    std::vector<board::Position> positions;
+    Square squares[bitbase::MAX_MEN];
+    while (positions.size() < 4096) {
+        board::Position pos;
+        const uint64_t idx = rng() % ix.size();
+        if (ix.decode(idx, squares) && set_position(pos, ix, squares, WHITE, rng() & 1)) positions.push_back(pos);
+    }
+    const int rounds = 256;
+    uint64_t wins = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        for (const board::Position& pos : positions) {
+            Wdl wdl;
+            wins += bitbase::probe(pos, wdl) && wdl == Wdl::Win;
+        }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << m.name() << ": " << static_cast<uint64_t>(rounds * positions.size() / seconds) << " probes/s ("
+              << wins << " wins)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bitboard::init();
+    zobrist::init();
+
+    const std::string dir = argc > 1 ? argv[1] : (std::filesystem::temp_directory_path() / "phish_bitbase").string();
+    std::vector<std::string> names;
+    for (int i = 2; i < argc; ++i) names.push_back(argv[i]);
+    if (names.empty()) names = {"KPvK", "KRvKN"};
+
+    std::filesystem::create_directories(dir);
+    for (const auto& entry : std::filesystem::directory_iterator(dir))
+        if (entry.path().extension() == ".pbb") std::filesystem::remove(entry.path());
+
+    std::vector<bitbase::Material> targets;
+    for (const std::string& name : names) {
+        bitbase::Material m;
+        if (!bitbase::parse_material(name, m)) {
+            std::cerr << "not a bitbase material: " << name << "\n";
+            return 1;
+        }
+        if (!build(m, dir)) return 1;
+        targets.push_back(m);
+    }
+
+    // Reload through the directory scan, as the engine does.
+    std::string message;
+    bitbase::load(dir, message);
+    std::cout << message << "\n";
+
+    std::mt19937_64 rng(20240611);
+    for (const bitbase::Material& m : bitbase::all_materials())
+        if (bitbase::loaded(m)) {
+            check_table(m, rng);
+            if (m.men() == 3) forward_solve(m);
+        }
+    check_known();
+    bench_probes(targets.back(), rng);
+
+    if (failures) {
+        std::cerr << failures << " failures\n";
+        return 1;
+    }
+    std::cout << "all bitbase checks passed\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+// Checks the df-pn mate solver on a mate-in-N list and compares it with the
+// alpha-beta search. Lines are "<fen>;<moves>", each a shortest mate. The
+// solver must prove exactly that length and return a legal line ending in
+// mate; the alpha-beta search is only timed, up to a node cap, until it
+// first reports the same mate score.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "engine/bitboard/bitboard.h"
+#include "engine/util/zobrist.h"
+#include "engine/board/position.h"
+#include "engine/search/mate.h"
+#include "engine/search/search.h"
+
+namespace {
+
+using namespace phish;
+
+// True if `pv` is legal from `pos` and leaves the side to move mated.
+bool mating_line(board::Position pos, const std::vector<movegen::Move>& pv) {
+    std::vector<board::StateInfo> states(pv.size());
+    for (std::size_t i = 0; i < pv.size(); ++i) {
+        movegen::MoveList legal;
+        pos.generate_legal(legal);
+        bool found = false;
+        for (const movegen::Move m : legal) found |= m == pv[i];
+        if (!found) return false;
+        pos.make_move(pv[i], states[i]);
+    }
+    movegen::MoveList replies;
+    pos.generate_legal(replies);
+    return replies.size() == 0 && pos.in_check();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bitboard::init();
+    zobrist::init();
+
+    const std::string file = argc > 1 ? argv[1] : "tests/mate/mate_positions.txt";
+    const uint64_t searchNodes = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+    std::ifstream in(file);
+    if (!in) {
+        std::cerr << "Failed to open mate list: " << file << "\n";
+        return 1;
+    }
+
+    search::MateSolver solver(16);
+    search::TranspositionTable tt(16);
+    search::SearchContext context(tt);
+
+    std::string line;
+    int failures = 0, positions = 0, searchFound = 0;
+    uint64_t solverNodes = 0, solverMs = 0;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::string fen, movesStr;
+        if (!std::getline(iss, fen, ';') || !std::getline(iss, movesStr, ';')) continue;
+        const int moves = std::atoi(movesStr.c_str());
+        board::Position pos;
+        pos.set_fen(fen);
+        ++positions;
+
+        solver.clear();
+        const search::MateResult mate = solver.solve(pos, moves, search::Limits{});
+        solverNodes += mate.nodes;
+        solverMs += static_cast<uint64_t>(mate.timeMs);
+        const bool ok = mate.mateIn == moves && mate.pv.size() == static_cast<std::size_t>(2 * moves - 1) &&
+                        mating_line(pos, mate.pv);
+
+        // Alpha-beta until its first exact score of this mate.
+        tt.clear();
+        context.clear();
+        std::atomic<bool> stop{false};
+        uint64_t foundNodes = 0;
+        int64_t foundMs = -1;
+        search::Limits limits;
+        limits.nodes = searchNodes;
+        limits.stop = &stop;
+        limits.onInfo = [&](const search::SearchInfo& info) {
+            if (info.lowerBound || info.upperBound || info.score < search::VALUE_MATE - (2 * moves - 1)) return;
+            foundNodes = info.nodes;
+            foundMs = info.timeMs;
+            stop = true;
+        };
+        context.think(pos, limits);
+        if (foundMs >= 0) ++searchFound;
+
+        std::cout << fen << ";" << moves << " df-pn " << (ok ? "ok" : "FAIL") << " nodes " << mate.nodes << " time "
+                  << mate.timeMs << " | alpha-beta ";
+        if (foundMs >= 0) std::cout << "nodes " << foundNodes << " time " << foundMs << "\n";
+        else std::cout << "not found in " << searchNodes << " nodes\n";
+        if (!ok) {
+            std::cerr << "Expected mate in " << moves << ", solver reported " << mate.mateIn << "\n";
+            ++failures;
+        }
+    }
+
+    std::cout << "df-pn solved " << (positions - failures) << "/" << positions << " nodes " << solverNodes << " time "
+              << solverMs << "; alpha-beta found " << searchFound << "/" << positions << "\n";
+    return failures == 0 ? 0 : 2;
+}
\ No newline at end of file
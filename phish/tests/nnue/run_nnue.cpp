@@ -0,0 +1,251 @@
+// NNUE checks on random networks of both feature sets: a save/load round
+// trip, then a walk over small move trees (null moves included) where the
+// incrementally updated accumulators of every SIMD path must equal a fresh
+// refresh bit for bit, and all paths must agree on every evaluation.
+// Leaves of the walk are then evaluated again in batches, which must give
+// the same scores. Finishes with evals/s per path: the forward pass alone,
+// the walk with its incremental updates, and unrelated positions one at a
+// time against batched.
+//
+// Usage: phish_nnue [depth]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/bitboard/bitboard.h"
+#include "engine/util/zobrist.h"
+#include "engine/board/position.h"
+#include "engine/eval/nnue/nnue.h"
+
+namespace {
+
+using namespace phish;
+using namespace phish::eval::nnue;
+
+const char* const FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+};
+
+constexpr Simd PATHS[] = {Simd::Scalar, Simd::SSSE3, Simd::AVX2};
+
+constexpr std::size_t MAX_LEAVES = 20000;
+
+struct Walk {
+    const Network& net;
+    std::vector<Simd> paths;
+    std::vector<std::unique_ptr<AccumulatorStack>> stacks; // one per path, updated at every node
+    std::unique_ptr<AccumulatorStack> lazy = std::make_unique<AccumulatorStack>(); // updated at leaves only
+    std::unique_ptr<AccumulatorStack> fresh = std::make_unique<AccumulatorStack>(); // refreshed at every node
+    uint64_t nodes = 0;
+    int failures = 0;
+    // Leaf positions with their scores, for the batch checks.
+    std::vector<board::Position> leaves{};
+    std::vector<int> leafScores{};
+
+    void reset() {
+        for (auto& s : stacks) s->reset();
+        lazy->reset();
+    }
+
+    void push(const board::DirtyPiece& dirty) {
+        for (auto& s : stacks) s->push(dirty);
+        lazy->push(dirty);
+    }
+
+    void pop() {
+        for (auto& s : stacks) s->pop();
+        lazy->pop();
+    }
+
+    bool same(const Accumulator& a, const Accumulator& b) {
+        return std::memcmp(a.values, b.values, sizeof(a.values)) == 0;
+    }
+
+    void check(const board::Position& pos, bool leaf) {
+        ++nodes;
+        fresh->reset();
+        const Accumulator& expected = fresh->update(pos, net, Simd::Scalar);
+        const int expectedEval = evaluate(pos, net, *fresh, Simd::Scalar);
+        bool ok = true;
+        for (std::size_t i = 0; i < paths.size(); ++i) {
+            ok &= same(stacks[i]->update(pos, net, paths[i]), expected);
+            ok &= evaluate(pos, net, *stacks[i], paths[i]) == expectedEval;
+        }
+        if (leaf) ok &= same(lazy->update(pos, net, Simd::Scalar), expected);
+        if (leaf && leaves.size() < MAX_LEAVES) {
+            leaves.push_back(pos);
+            leafScores.push_back(expectedEval);
+        }
+        if (!ok && failures++ < 5) std::cerr << "mismatch after " << nodes << " nodes\n";
+    }
+
+    void run(board::Position& pos, int depth) {
+        check(pos, depth == 0);
+        if (depth == 0) return;
+        movegen::MoveList moves;
+        pos.generate_legal(moves);
+        for (const movegen::Move m : moves) {
+            board::StateInfo st;
+            if (!pos.make_move(m, st)) continue;
+            push(st.dirty);
+            run(pos, depth - 1);
+            pop();
+            pos.unmake_move(m, st);
+        }
+        board::StateInfo st;
+        if (depth >= 2 && !pos.in_check() && pos.make_null_move(st)) {
+            push(st.dirty);
+            run(pos, depth - 1);
+            pop();
+            pos.unmake_null_move(st);
+        }
+    }
+};
+
+bool same_network(const Network& a, const Network& b) {
+    return a.image_size() == b.image_size() && std::memcmp(a.image(), b.image(), a.image_size()) == 0;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<const board::Position*> pointers(const std::vector<board::Position>& positions) {
+    std::vector<const board::Position*> out;
+    for (const board::Position& pos : positions) out.push_back(&pos);
+    return out;
+}
+
+int check_batch(const Network& net, const Walk& walk, Simd simd) {
+    const auto batch = pointers(walk.leaves);
+    std::vector<int> scores(batch.size());
+    evaluate_batch(batch.data(), static_cast<int>(batch.size()), net, scores.data(), simd);
+    const bool ok = scores == walk.leafScores;
+    if (!ok) std::cerr << simd_name(simd) << ": batch scores differ\n";
+    return ok ? 0 : 1;
+}
+
+// The packed records evalbatch reads must decode to the same position.
+int check_packed(const Walk& walk) {
+    int failures = 0;
+    for (const board::Position& pos : walk.leaves) {
+        board::Position copy;
+        board::PackedPosition packed;
+        bool same = pos.pack(packed) && copy.set_packed(packed) && copy.key() == pos.key();
+        for (int s = 0; s < 64 && same; ++s)
+            same = copy.piece_at(static_cast<Square>(s)) == pos.piece_at(static_cast<Square>(s));
+        if (!same) ++failures;
+    }
+    if (failures) std::cerr << failures << " packed positions differ\n";
+    return failures ? 1 : 0;
+}
+
+// Forward passes over already computed accumulators, a depth-3 walk from
+// the start position with an evaluation at every node, then `positions`
+// refreshed and evaluated one at a time, and in batches.
+void benchmark(const Network& net, Simd simd, const std::vector<board::Position>& positions) {
+    constexpr int REPEATS = 20000;
+    auto stack = std::make_unique<AccumulatorStack>();
+    board::Position pos;
+    pos.set_fen(FENS[1]);
+    stack->reset();
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < REPEATS; ++i) sink = sink + evaluate(pos, net, *stack, simd);
+    const double forward = REPEATS / seconds_since(start);
+
+    uint64_t evals = 0;
+    pos.set_fen(FENS[0]);
+    stack->reset();
+    start = std::chrono::steady_clock::now();
+    {
+        auto walk = [&](auto& self, int depth) -> void {
+            sink = sink + evaluate(pos, net, *stack, simd);
+            ++evals;
+            if (depth == 0) return;
+            movegen::MoveList moves;
+            pos.generate_legal(moves);
+            for (const movegen::Move m : moves) {
+                board::StateInfo st;
+                if (!pos.make_move(m, st)) continue;
+                stack->push(st.dirty);
+                self(self, depth - 1);
+                stack->pop();
+                pos.unmake_move(m, st);
+            }
+        };
+        walk(walk, 3);
+    }
+    const double walked = static_cast<double>(evals) / seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (const board::Position& p : positions) {
+        stack->reset();
+        sink = sink + evaluate(p, net, *stack, simd);
+    }
+    const double single = static_cast<double>(positions.size()) / seconds_since(start);
+
+    const auto batch = pointers(positions);
+    std::vector<int> scores(batch.size());
+    start = std::chrono::steady_clock::now();
+    evaluate_batch(batch.data(), static_cast<int>(batch.size()), net, scores.data(), simd);
+    const double batched = static_cast<double>(positions.size()) / seconds_since(start);
+
+    std::printf("  %-6s forward %9.0f  walk %9.0f  single %9.0f  batch %9.0f evals/s\n", simd_name(simd), forward,
+                walked, single, batched);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bitboard::init();
+    zobrist::init();
+    const int depth = argc > 1 ? std::atoi(argv[1]) : 3;
+
+    std::vector<Simd> paths;
+    for (const Simd simd : PATHS)
+        if (simd_supported(simd)) paths.push_back(simd);
+
+    int failures = 0;
+    for (const FeatureSet fs : {FeatureSet::HalfKP, FeatureSet::HalfKA}) {
+        auto net = random_network(fs, 2024 + static_cast<uint64_t>(fs));
+        const std::string path = std::string("phish_nnue_test_") + feature_set_name(fs) + ".nnue";
+        std::string error;
+        std::unique_ptr<Network> loaded;
+        if (save(*net, path)) loaded = load(path, error);
+        std::remove(path.c_str());
+        if (!loaded || !same_network(*net, *loaded)) {
+            std::cerr << feature_set_name(fs) << ": save/load round trip failed " << error << "\n";
+            ++failures;
+            continue;
+        }
+
+        Walk walk{*loaded, paths, {}};
+        for (std::size_t i = 0; i < paths.size(); ++i) walk.stacks.push_back(std::make_unique<AccumulatorStack>());
+        for (const char* fen : FENS) {
+            board::Position pos;
+            pos.set_fen(fen);
+            walk.reset();
+            walk.run(pos, depth);
+        }
+        std::printf("%s (%s): %llu nodes, %d mismatches\n", feature_set_name(fs), storage_name(loaded->storage),
+                    static_cast<unsigned long long>(walk.nodes), walk.failures);
+        failures += walk.failures;
+        for (const Simd simd : paths) failures += check_batch(*loaded, walk, simd);
+        failures += check_packed(walk);
+
+        for (const Simd simd : paths) benchmark(*loaded, simd, walk.leaves);
+    }
+
+    return failures == 0 ? 0 : 2;
+}
\ No newline at end of file
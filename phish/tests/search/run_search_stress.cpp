@@ -0,0 +1,128 @@
+// Runs 64 searches concurrently, each in its own SearchContext. Half of them
+// have a private TT and must reproduce, node for node, the result of the
+// same search run alone; the other half share one TT, which makes them
+// nondeterministic, so they are only checked for a legal best move and PV.
+// Every root position must come back unchanged.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/bitboard/bitboard.h"
+#include "engine/util/zobrist.h"
+#include "engine/board/position.h"
+#include "engine/search/search.h"
+
+namespace {
+
+using namespace phish;
+
+constexpr int SEARCHES = 64;
+constexpr int PRIVATE_SEARCHES = SEARCHES / 2;
+
+const char* const FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r2q1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 9",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+struct Job {
+    const char* fen;
+    int depth;
+    search::SearchResult result;
+    bool rootIntact = false;
+};
+
+Job make_job(int i) {
+    constexpr int count = static_cast<int>(std::size(FENS));
+    return Job{FENS[i % count], 5 + (i / count) % 3, {}, false};
+}
+
+void run_job(Job& job, search::TranspositionTable& tt) {
+    search::SearchContext context(tt);
+    board::Position pos;
+    pos.set_fen(job.fen);
+    const U64 key = pos.key();
+    search::Limits limits;
+    limits.depth = job.depth;
+    job.result = context.think(pos, limits);
+    job.rootIntact = pos.key() == key;
+}
+
+// Every PV move must be legal in the position reached by the moves before it.
+bool legal_line(const char* fen, const std::vector<movegen::Move>& pv) {
+    board::Position pos;
+    pos.set_fen(fen);
+    std::vector<board::StateInfo> states(pv.size());
+    for (std::size_t i = 0; i < pv.size(); ++i) {
+        movegen::MoveList legal;
+        pos.generate_legal(legal);
+        if (std::find(legal.begin(), legal.end(), pv[i]) == legal.end()) return false;
+        pos.make_move(pv[i], states[i]);
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    bitboard::init();
+    zobrist::init();
+
+    // References: the private-TT searches, one at a time.
+    std::vector<Job> expected;
+    for (int i = 0; i < PRIVATE_SEARCHES; ++i) {
+        expected.push_back(make_job(i));
+        search::TranspositionTable tt(1);
+        tt.clear();
+        run_job(expected.back(), tt);
+    }
+
+    std::vector<Job> jobs;
+    std::vector<std::unique_ptr<search::TranspositionTable>> privateTables;
+    for (int i = 0; i < SEARCHES; ++i) jobs.push_back(make_job(i));
+    for (int i = 0; i < PRIVATE_SEARCHES; ++i) {
+        privateTables.push_back(std::make_unique<search::TranspositionTable>(1));
+        privateTables.back()->clear();
+    }
+    search::TranspositionTable shared(16);
+    shared.clear();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < SEARCHES; ++i) {
+        search::TranspositionTable& tt = i < PRIVATE_SEARCHES ? *privateTables[i] : shared;
+        threads.emplace_back([&job = jobs[i], &tt] { run_job(job, tt); });
+    }
+    for (std::thread& t : threads) t.join();
+
+    int failures = 0;
+    for (int i = 0; i < SEARCHES; ++i) {
+        const Job& job = jobs[i];
+        const search::SearchResult& r = job.result;
+        std::string error;
+        if (!job.rootIntact) error = "root position changed";
+        else if (r.depth != job.depth) error = "stopped at depth " + std::to_string(r.depth);
+        else if (r.pv.empty() || r.pv[0] != r.bestMove || !legal_line(job.fen, r.pv)) error = "illegal best move or PV";
+        else if (i < PRIVATE_SEARCHES) {
+            const search::SearchResult& e = expected[i].result;
+            if (r.nodes != e.nodes || r.bestMove != e.bestMove || r.score != e.score || r.pv != e.pv)
+                error = "differs from the single-threaded search (nodes " + std::to_string(r.nodes) + " vs " +
+                        std::to_string(e.nodes) + ")";
+        }
+        std::cout << i << (i < PRIVATE_SEARCHES ? " private " : " shared ") << "depth " << job.depth << " nodes "
+                  << r.nodes << " score " << r.score << (error.empty() ? "" : " FAIL: " + error) << "\n";
+        if (!error.empty()) ++failures;
+    }
+
+    std::cout << (SEARCHES - failures) << "/" << SEARCHES << " searches ok\n";
+    return failures == 0 ? 0 : 2;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+// Checks the tuner's view of the classical evaluation: at every node of
+// small move trees, the traced coefficients under the compiled weights must
+// give exactly what evaluate() returns. With a path to weights.h, also
+// checks that weights_header() writes that file back unchanged, so a tuned
+// header drops in place.
+//
+// Usage: phish_trace [depth] [weights.h]
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "engine/bitboard/bitboard.h"
+#include "engine/util/zobrist.h"
+#include "engine/board/position.h"
+#include "engine/eval/evaluate.h"
+#include "engine/eval/trace.h"
+
+namespace {
+
+using namespace phish;
+
+const char* const FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "2r2rk1/pp3ppp/2n1p3/3pP3/3P4/P1N2N2/1P3PPP/2R2RK1 w - - 0 1",
+    "8/5k2/3b4/3P4/2P1B3/6P1/5K2/8 w - - 0 1",
+    "8/8/1k6/8/8/1PB5/1K6/8 w - - 0 1",
+    "6k1/5p2/4p1p1/8/1N6/1P3PP1/5K2/8 b - - 0 1",
+};
+
+struct Walk {
+    std::unique_ptr<eval::EvalState> state = std::make_unique<eval::EvalState>();
+    int mg[eval::WEIGHT_NB] = {};
+    int eg[eval::WEIGHT_NB] = {};
+    eval::EvalTrace trace{};
+    uint64_t nodes = 0;
+    uint64_t traced = 0;
+    int failures = 0;
+
+    void check(const board::Position& pos) {
+        ++nodes;
+        if (!eval::trace(pos, *state, trace)) return;
+        ++traced;
+        const int expected = eval::evaluate(pos, *state);
+        const int value = eval::traced_value(trace, mg, eg);
+        const int got = pos.side_to_move() == WHITE ? value : -value;
+        if (got != expected && failures++ < 5)
+            std::cerr << "traced " << got << ", evaluate " << expected << " after " << nodes << " nodes\n";
+    }
+
+    void run(board::Position& pos, int depth) {
+        check(pos);
+        if (depth == 0) return;
+        movegen::MoveList moves;
+        pos.generate_legal(moves);
+        for (const movegen::Move m : moves) {
+            board::StateInfo st;
+            if (!pos.make_move(m, st)) continue;
+            run(pos, depth - 1);
+            pos.unmake_move(m, st);
+        }
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bitboard::init();
+    zobrist::init();
+    const int depth = argc > 1 ? std::atoi(argv[1]) : 3;
+
+    Walk walk;
+    eval::current_weights(walk.mg, walk.eg);
+    for (const char* fen : FENS) {
+        board::Position pos;
+        pos.set_fen(fen);
+        walk.run(pos, depth);
+    }
+    std::printf("%llu nodes, %llu traced, %d mismatches\n", static_cast<unsigned long long>(walk.nodes),
+                static_cast<unsigned long long>(walk.traced), walk.failures);
+    int failures = walk.failures;
+
+    if (argc > 2) {
+        std::ifstream in(argv[2], std::ios::binary);
+        std::stringstream text;
+        text << in.rdbuf();
+        const bool same = in && text.str() == eval::weights_header(walk.mg, walk.eg);
+        std::printf("%s: %s\n", argv[2], same ? "written back unchanged" : "differs from weights_header()");
+        failures += same ? 0 : 1;
+    }
+    return failures == 0 ? 0 : 2;
+}
\ No newline at end of file
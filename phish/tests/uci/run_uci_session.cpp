@@ -0,0 +1,164 @@
+// Drives the engine binary through a scripted UCI session and checks the
+// timing of its replies. Script lines:
+//   send <command>          write a line to the engine
+//   sleep <ms>              pause
+//   expect <ms> <text>      a line containing <text> must arrive within <ms>
+//   quiet <ms> <text>       no line containing <text> may arrive within <ms>
+//   exit <ms>               the engine must exit within <ms>
+// Lines starting with '#' are comments. POSIX only.
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Engine {
+    pid_t pid = -1;
+    int in = -1;  // engine stdin
+    int out = -1; // engine stdout
+    std::string pending;
+
+    bool spawn(const char* path) {
+        int toEngine[2], fromEngine[2];
+        if (pipe(toEngine) != 0 || pipe(fromEngine) != 0) return false;
+        pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0) {
+            dup2(toEngine[0], STDIN_FILENO);
+            dup2(fromEngine[1], STDOUT_FILENO);
+            close(toEngine[1]);
+            close(fromEngine[0]);
+            execl(path, path, static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        close(toEngine[0]);
+        close(fromEngine[1]);
+        in = toEngine[1];
+        out = fromEngine[0];
+        return true;
+    }
+
+    void send(const std::string& line) {
+        const std::string data = line + "\n";
+        if (write(in, data.data(), data.size()) != static_cast<ssize_t>(data.size()))
+            std::cerr << "write failed: " << line << "\n";
+    }
+
+    // Next output line, or false on timeout/EOF.
+    bool read_line(std::string& line, Clock::time_point deadline) {
+        while (true) {
+            const auto nl = pending.find('\n');
+            if (nl != std::string::npos) {
+                line = pending.substr(0, nl);
+                pending.erase(0, nl + 1);
+                return true;
+            }
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            if (left <= 0) return false;
+            pollfd pfd{out, POLLIN, 0};
+            if (poll(&pfd, 1, static_cast<int>(left)) <= 0) return false;
+            char buf[4096];
+            const ssize_t n = read(out, buf, sizeof(buf));
+            if (n <= 0) return false;
+            pending.append(buf, static_cast<std::size_t>(n));
+        }
+    }
+
+    bool wait_exit(int ms) {
+        const auto deadline = Clock::now() + std::chrono::milliseconds(ms);
+        while (Clock::now() < deadline) {
+            int status = 0;
+            if (waitpid(pid, &status, WNOHANG) == pid) return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            usleep(1000);
+        }
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return false;
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: phish_uci_session <engine> <script>\n";
+        return 1;
+    }
+    std::ifstream script(argv[2]);
+    if (!script) {
+        std::cerr << "Failed to open session script: " << argv[2] << "\n";
+        return 1;
+    }
+    Engine engine;
+    if (!engine.spawn(argv[1])) {
+        std::cerr << "Failed to start engine: " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::string line;
+    int lineNo = 0, failures = 0;
+    bool exited = false;
+    while (std::getline(script, line)) {
+        ++lineNo;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream iss(line);
+        std::string op;
+        iss >> op;
+        if (op == "send") {
+            std::string cmd;
+            std::getline(iss >> std::ws, cmd);
+            engine.send(cmd);
+            std::cout << "> " << cmd << "\n";
+        } else if (op == "sleep") {
+            int ms = 0;
+            iss >> ms;
+            usleep(static_cast<useconds_t>(ms) * 1000);
+        } else if (op == "expect" || op == "quiet") {
+            int ms = 0;
+            std::string text;
+            iss >> ms;
+            std::getline(iss >> std::ws, text);
+            const auto start = Clock::now();
+            const auto deadline = start + std::chrono::milliseconds(ms);
+            bool seen = false;
+            std::string got;
+            while (engine.read_line(got, deadline)) {
+                if (got.find(text) != std::string::npos) {
+                    seen = true;
+                    break;
+                }
+            }
+            const auto took = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+            if (seen) std::cout << "< " << got << " (" << took << " ms)\n";
+            if (seen != (op == "expect")) {
+                std::cerr << "line " << lineNo << ": " << line << (seen ? ": unexpected output" : ": timed out") << "\n";
+                ++failures;
+            }
+        } else if (op == "exit") {
+            int ms = 0;
+            iss >> ms;
+            exited = true;
+            if (!engine.wait_exit(ms)) {
+                std::cerr << "line " << lineNo << ": engine did not exit cleanly\n";
+                ++failures;
+            }
+        }
+    }
+    if (!exited) {
+        kill(engine.pid, SIGKILL);
+        waitpid(engine.pid, nullptr, 0);
+    }
+
+    return failures == 0 ? 0 : 2;
+}
\ No newline at end of file
@@ -0,0 +1,6 @@
+#include <string>
+#include <vector>
+
+#include "engine/tools/tune.h"
+
+int main(int argc, char** argv) { return phish::tools::tune(std::vector<std::string>(argv + 1, argv + argc)); }
\ No newline at end of file